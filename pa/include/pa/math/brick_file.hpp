@@ -0,0 +1,77 @@
+#ifndef PA_MATH_BRICK_FILE_HPP
+#define PA_MATH_BRICK_FILE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <highfive/H5DataSet.hpp>
+
+#include <pa/export.hpp>
+
+namespace pa
+{
+// Preprocessed, memory-mappable bricked dataset. The file consists of:
+// - The header, padded to a page.
+// - The metadata of each brick in row-major brick order, padded to a page.
+// - The stored bricks along the Morton curve, beginning at a page boundary. Slot 0 holds a brick of zeros which all empty bricks refer to.
+// Each brick holds brick_size^3 elements of components floats, row-major within the brick (the layout of bricked_array).
+class PA_EXPORT brick_file
+{
+public:
+  static constexpr std::uint64_t magic      = 0x31534b4349524250; // "PBRICKS1" in little endian.
+  static constexpr std::size_t   page_size  = 4096;
+  static constexpr std::size_t   brick_size = 8;
+
+  struct file_header
+  {
+    std::uint64_t                magic           = brick_file::magic;
+    std::array<std::uint64_t, 3> shape           = {};
+    std::array<std::uint64_t, 3> brick_counts    = {};
+    std::uint64_t                components      = 1;
+    std::uint64_t                brick_size      = brick_file::brick_size;
+    std::uint64_t                stored_bricks   = 1; // Including the zero brick.
+    std::uint64_t                metadata_offset = 0;
+    std::uint64_t                data_offset     = 0;
+    std::uint64_t                source_size     = 0; // Size of the converted file in bytes, 0 if unknown.
+    std::uint64_t                source_time     = 0; // Modification time of the converted file in seconds since the epoch, 0 if unknown.
+  };
+  struct brick_metadata
+  {
+    std::uint32_t                slot            = 0; // 0 if the brick is empty.
+    std::uint32_t                occupancy       = 0; // Number of non-zero elements.
+    float                        minimum         = 0; // Minimum value, or magnitude if there are multiple components.
+    float                        maximum         = 0; // Maximum value, or magnitude if there are multiple components.
+  };
+
+  // Converts a dataset of shape (x, y, z) or (x, y, z, components) into a brick file. Reads one brick-thick slab at a time.
+  // Only the region [origin, origin + shape) is converted. Zero extents of the shape extend to the end of the dataset.
+  // The size and modification time of the file holding the dataset are stored in the header, allowing to detect stale conversions.
+  static void create(const HighFive::DataSet& dataset, const std::string& filepath, const std::array<std::size_t, 3>& origin = {}, const std::array<std::size_t, 3>& shape = {}, std::uint64_t source_size = 0, std::uint64_t source_time = 0);
+
+  explicit brick_file  (const std::string& filepath); // Throws std::runtime_error if the file is not a valid brick file.
+  brick_file           (const brick_file&  that) = delete ;
+  brick_file           (      brick_file&& temp) = default;
+  virtual ~brick_file  ()                        = default;
+  brick_file& operator=(const brick_file&  that) = delete ;
+  brick_file& operator=(      brick_file&& temp) = default;
+
+  const file_header&           header     () const;
+  const brick_metadata&        metadata   (std::size_t x, std::size_t y, std::size_t z) const; // In brick coordinates.
+  
+  // Returns the stored bricks, sharing the ownership of the mapping.
+  template <typename type>
+  std::shared_ptr<const type>  bricks     () const
+  {
+    return std::shared_ptr<const type>(file_, reinterpret_cast<const type*>(file_->data() + header().data_offset));
+  }
+
+protected:
+  std::shared_ptr<boost::iostreams::mapped_file_source> file_;
+};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,238 @@
+#ifndef PA_MATH_BRICKED_ARRAY_HPP
+#define PA_MATH_BRICKED_ARRAY_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <pa/math/index.hpp>
+
+namespace pa
+{
+// Three dimensional array stored in cubic bricks of brick_size^3 elements (row-major within a brick).
+// Bricks are placed in memory along a Morton (Z-order) curve, so that spatially adjacent bricks are also close in memory.
+// The brick table maps the row-major index of a brick to its slot in memory.
+// Sparse arrays map every brick to a single shared brick filled with a background value, and only store the bricks allocated explicitly.
+// Mapped arrays view read-only bricks stored elsewhere (e.g. a memory-mapped file) without copying. Their region may begin within a brick.
+// Dense arrays may also be placed in writable storage owned elsewhere (e.g. a shared memory window), which they fill and then view as mapped arrays.
+template <typename type, std::size_t brick_size = 8>
+class bricked_array
+{
+public:
+  static_assert((brick_size & (brick_size - 1)) == 0, "Brick size must be a power of two.");
+
+  using size_type  = std::size_t;
+  using shape_type = std::array<size_type, 3>;
+
+  static constexpr size_type size         = brick_size;
+  static constexpr size_type volume       = brick_size * brick_size * brick_size;
+  static constexpr size_type stride_x     = brick_size * brick_size;
+  static constexpr size_type stride_y     = brick_size;
+  static constexpr size_type stride_z     = 1;
+
+  void              resize       (const shape_type& shape)
+  {
+    shape_   = shape;
+    origin_  = {0, 0, 0};
+    sparse_  = false;
+    storage_ = nullptr;
+    mapped_.reset();
+    for (auto i = 0; i < 3; ++i)
+      brick_counts_[i] = (shape_[i] + brick_size - 1) / brick_size;
+
+    table_ = morton_table(shape_);
+
+    data_.clear        ();
+    data_.shrink_to_fit();
+    data_.resize       (table_.size() * volume);
+  }
+  // Places the bricks in the storage instead of allocating them. The storage holds storage_size(shape) elements and outlives the array.
+  void              resize       (const shape_type& shape, type* storage)
+  {
+    map(shape, {0, 0, 0}, morton_table(shape), std::shared_ptr<const type>(std::shared_ptr<const type>(), storage));
+    storage_ = storage;
+  }
+  void              resize_sparse(const shape_type& shape, const type& background)
+  {
+    shape_   = shape;
+    origin_  = {0, 0, 0};
+    sparse_  = true;
+    storage_ = nullptr;
+    mapped_.reset();
+    for (auto i = 0; i < 3; ++i)
+      brick_counts_[i] = (shape_[i] + brick_size - 1) / brick_size;
+
+    table_.clear       ();
+    table_.resize      (brick_counts_[0] * brick_counts_[1] * brick_counts_[2], 0);
+    data_ .clear       ();
+    data_ .shrink_to_fit();
+    data_ .resize      (volume, background);
+  }
+  // Allocates the brick (x, y, z) of a sparse array (in brick coordinates), filled with the background value, after the bricks allocated before. Not thread-safe.
+  void              allocate     (const size_type x, const size_type y, const size_type z)
+  {
+    auto& slot = table_[(x * brick_counts_[1] + y) * brick_counts_[2] + z];
+    if (slot != 0)
+      return;
+
+    const type background = data_.front();
+    slot = std::uint32_t(data_.size() / volume);
+    data_.resize(data_.size() + volume, background);
+  }
+  // Reorders the allocated bricks of a sparse array along the Morton curve. The bricks are swapped in place, hence without a second copy of the storage.
+  void              reorder      ()
+  {
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> codes;
+    for (size_type x = 0; x < brick_counts_[0]; ++x)
+    for (size_type y = 0; y < brick_counts_[1]; ++y)
+    for (size_type z = 0; z < brick_counts_[2]; ++z)
+    {
+      const auto index = (x * brick_counts_[1] + y) * brick_counts_[2] + z;
+      if (table_[index] != 0)
+        codes.emplace_back(morton_encode(std::uint32_t(x), std::uint32_t(y), std::uint32_t(z)), std::uint32_t(index));
+    }
+    std::sort(codes.begin(), codes.end());
+
+    // The target slot of the brick in each slot. Each cycle of the permutation is resolved by swapping its bricks into place one at a time.
+    std::vector<std::uint32_t> targets(codes.size() + 1, 0);
+    for (size_type slot = 1; slot <= codes.size(); ++slot)
+    {
+      auto& entry = table_[codes[slot - 1].second];
+      targets[entry] = std::uint32_t(slot);
+      entry          = std::uint32_t(slot);
+    }
+    for (size_type slot = 1; slot < targets.size(); ++slot)
+    {
+      while (targets[slot] != slot)
+      {
+        const auto target = targets[slot];
+        std::swap_ranges(data_.begin() + slot * volume, data_.begin() + (slot + 1) * volume, data_.begin() + size_type(target) * volume);
+        std::swap(targets[slot], targets[target]);
+      }
+    }
+  }
+
+  // Views the region of the given shape, beginning at the origin within the first brick. The table maps the bricks overlapping the region to slots of the storage.
+  void              map          (const shape_type& shape, const shape_type& origin, std::vector<std::uint32_t> table, std::shared_ptr<const type> storage)
+  {
+    shape_   = shape;
+    origin_  = origin;
+    sparse_  = false;
+    storage_ = nullptr;
+    for (auto i = 0; i < 3; ++i)
+      brick_counts_[i] = (origin_[i] + shape_[i] + brick_size - 1) / brick_size;
+
+    table_  = std::move(table);
+    data_  .clear        ();
+    data_  .shrink_to_fit();
+    mapped_ = std::move(storage);
+  }
+
+  // Returns the brick table of a dense array of the given shape, which places all bricks along the Morton curve.
+  static std::vector<std::uint32_t> morton_table(const shape_type& shape)
+  {
+    shape_type counts;
+    for (auto i = 0; i < 3; ++i)
+      counts[i] = (shape[i] + brick_size - 1) / brick_size;
+
+    const auto brick_count = counts[0] * counts[1] * counts[2];
+
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> codes(brick_count);
+    for (size_type x = 0; x < counts[0]; ++x)
+    for (size_type y = 0; y < counts[1]; ++y)
+    for (size_type z = 0; z < counts[2]; ++z)
+    {
+      const auto index = (x * counts[1] + y) * counts[2] + z;
+      codes[index] = {morton_encode(std::uint32_t(x), std::uint32_t(y), std::uint32_t(z)), std::uint32_t(index)};
+    }
+    std::sort(codes.begin(), codes.end());
+
+    std::vector<std::uint32_t> table(brick_count);
+    for (size_type slot = 0; slot < brick_count; ++slot)
+      table[codes[slot].second] = std::uint32_t(slot);
+    return table;
+  }
+  // Returns the number of elements of a dense array of the given shape.
+  static size_type                  storage_size(const shape_type& shape)
+  {
+    size_type bricks = 1;
+    for (auto i = 0; i < 3; ++i)
+      bricks *= (shape[i] + brick_size - 1) / brick_size;
+    return bricks * volume;
+  }
+
+  const shape_type& shape        () const
+  {
+    return shape_;
+  }
+  const shape_type& brick_counts () const
+  {
+    return brick_counts_;
+  }
+  size_type         num_elements () const // Number of stored elements, including the shared brick of sparse arrays. Zero if the storage is owned elsewhere.
+  {
+    return data_.size();
+  }
+  bool              empty        () const
+  {
+    return data_.empty() && !mapped_;
+  }
+  bool              sparse       () const
+  {
+    return sparse_;
+  }
+  bool              mapped       () const
+  {
+    return mapped_ != nullptr;
+  }
+
+  // Returns the memory index of the element at (x, y, z).
+  size_type         index        (size_type x, size_type y, size_type z) const
+  {
+    x += origin_[0];
+    y += origin_[1];
+    z += origin_[2];
+    const auto brick = table_[(x / brick_size * brick_counts_[1] + y / brick_size) * brick_counts_[2] + z / brick_size];
+    return size_type(brick) * volume + (x % brick_size) * stride_x + (y % brick_size) * stride_y + (z % brick_size) * stride_z;
+  }
+  // Returns true if the 2x2x2 neighborhood starting at (x, y, z) lies within a single brick.
+  bool              interior     (const size_type x, const size_type y, const size_type z) const
+  {
+    return (x + origin_[0]) % brick_size != brick_size - 1 && (y + origin_[1]) % brick_size != brick_size - 1 && (z + origin_[2]) % brick_size != brick_size - 1;
+  }
+
+        type&       operator()   (const size_type x, const size_type y, const size_type z)
+  {
+    return data()[index(x, y, z)];
+  }
+  const type&       operator()   (const size_type x, const size_type y, const size_type z) const
+  {
+    return data()[index(x, y, z)];
+  }
+
+        type*       data         ()
+  {
+    return storage_ ? storage_ : data_.data();
+  }
+  const type*       data         () const
+  {
+    return mapped_ ? mapped_.get() : data_.data();
+  }
+
+protected:
+  shape_type                  shape_        {};
+  shape_type                  origin_       {};
+  shape_type                  brick_counts_ {};
+  std::vector<std::uint32_t>  table_        {};
+  std::vector<type>           data_         {};
+  std::shared_ptr<const type> mapped_       {};
+  type*                       storage_      = nullptr; // Writable view of mapped_, if placed in storage owned elsewhere.
+  bool                        sparse_       = false;
+};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef PA_MATH_GRADIENT_STENCIL_HPP
+#define PA_MATH_GRADIENT_STENCIL_HPP
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <pa/math/types.hpp>
+#include <pa/math/vector_field.hpp>
+#include <pa/export.hpp>
+
+namespace pa
+{
+// Computes the Jacobian of a vector field one row of voxels (along z) at a time.
+// The neighboring rows are gathered into one contiguous array per component, hence the arithmetic over a row vectorizes regardless of the layout.
+// Differences are central wherever both neighbors are stored, ghost layers included, and one-sided at the bounds of the stored voxels.
+// Holds the rows of a single thread; use one instance per thread.
+struct PA_EXPORT gradient_stencil
+{
+  using row = std::vector<scalar>;
+
+  explicit gradient_stencil(const vector_field* vector_field);
+
+  // Afterwards, jacobian[3 * i + j][z - z_begin] is the derivative of component i along axis j at the voxel (x, y, z).
+  void compute(std::size_t x, std::size_t y, std::size_t z_begin, std::size_t z_end);
+
+  const vector_field*        field    = nullptr;
+  std::array<std::size_t, 3> shape    {};
+  std::array<row, 3>         lower    {}; // Neighbor row along x or y, reused for both.
+  std::array<row, 3>         upper    {};
+  std::array<row, 3>         center   {}; // Padded with the neighbors along z.
+  std::array<row, 9>         jacobian {};
+
+protected:
+  void gather(std::size_t x, std::size_t y, std::size_t z_begin, std::size_t z_end, std::array<row, 3>& target) const;
+};
+}
+
+#endif
\ No newline at end of file
@@ -25,6 +25,21 @@ std::size_t ravel_multi_index(const type& multi_index, const type& dimensions)
     index = index * dimensions[i] + multi_index[i];
   return index;
 }
+inline std::uint64_t morton_encode(const std::uint32_t x, const std::uint32_t y, const std::uint32_t z)
+{
+  // Spreads the lower 21 bits of the value so that there are two zero bits between each bit.
+  const auto spread = [ ] (std::uint64_t value)
+  {
+    value &= 0x00000000001fffffull;
+    value  = (value | value << 32) & 0x001f00000000ffffull;
+    value  = (value | value << 16) & 0x001f0000ff0000ffull;
+    value  = (value | value <<  8) & 0x100f00f00f00f00full;
+    value  = (value | value <<  4) & 0x10c30c30c30c30c3ull;
+    value  = (value | value <<  2) & 0x1249249249249249ull;
+    return value;
+  };
+  return spread(x) << 2 | spread(y) << 1 | spread(z);
+}
 }
 
 #endif
\ No newline at end of file
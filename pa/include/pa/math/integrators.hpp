@@ -31,6 +31,14 @@ using variant_integrator                      = std::variant<
   runge_kutta_fehlberg_78_integrator          , 
   adams_bashforth_2_integrator                ,
   adams_bashforth_moulton_2_integrator        >;
+
+// The tracers sample the vector field once per step, hence a step of any single-step integrator reduces to x + h * v.
+// Multistep integrators additionally depend on the derivatives of previous steps.
+inline bool is_single_step(const variant_integrator& integrator)
+{
+  return !std::holds_alternative<adams_bashforth_2_integrator>        (integrator) &&
+         !std::holds_alternative<adams_bashforth_moulton_2_integrator>(integrator);
+}
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef PA_MATH_PACKET_SAMPLER_HPP
+#define PA_MATH_PACKET_SAMPLER_HPP
+
+#include <array>
+#include <cstddef>
+
+#include <Eigen/Core>
+
+#include <pa/math/types.hpp>
+#include <pa/math/vector_field.hpp>
+#include <pa/export.hpp>
+
+namespace pa
+{
+#if defined(__AVX512F__)
+constexpr std::size_t packet_size = 16;
+#else
+constexpr std::size_t packet_size = 8 ;
+#endif
+
+using packet_mask    = Eigen::Array<bool   , packet_size, 1>;
+using packet_scalar  = Eigen::Array<scalar , packet_size, 1>;
+using packet_vector3 = Eigen::Array<scalar , packet_size, 3>; // Column-major, i.e. one column per component.
+using packet_integer = Eigen::Array<integer, packet_size, 3>;
+
+// Locates cells and interpolates vector fields for a packet of particles in SIMD lanes. Each lane may sample a different field.
+struct PA_EXPORT packet_sampler
+{
+  void           set_vector_field(std::size_t lane, const vector_field* vector_field);
+
+  packet_mask    contains        (const packet_vector3& positions) const;
+  packet_mask    empty           (const packet_vector3& positions) const; // See vector_field::empty.
+  packet_vector3 interpolate     (const packet_vector3& positions, const packet_mask& active);
+
+  std::array<const vector_field*, packet_size>               vector_fields {};
+  std::array<vector_field::sample_cache, packet_size>        caches        {};
+  packet_vector3                                             offsets       = packet_vector3::Zero();
+  packet_vector3                                             spacings      = packet_vector3::Ones();
+  packet_vector3                                             upper_bounds  = packet_vector3::Zero(); // Shape - 1, the last valid cell subscript + 1.
+};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef PA_MATH_PARTICLE_ARRAY_HPP
+#define PA_MATH_PARTICLE_ARRAY_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <pa/math/particle.hpp>
+#include <pa/math/types.hpp>
+#include <pa/export.hpp>
+
+namespace pa
+{
+// Particles as a structure of arrays, one array per member of pa::particle.
+// The tracing loops read the positions and counters only, hence the provenance (original rank and voxel) is kept apart and not pulled through the cache.
+// Single particles are read and written as pa::particle by get, set and push_back.
+struct PA_EXPORT particle_array
+{
+  std::size_t size     () const;
+  bool        empty    () const;
+  void        resize   (std::size_t size);
+  void        reserve  (std::size_t size);
+  void        clear    ();
+
+  particle    get      (std::size_t index) const;
+  void        set      (std::size_t index, const particle& particle);
+  void        push_back(const particle& particle);
+  void        append   (const particle_array& that, std::size_t begin, std::size_t end); // Appends the particles [begin, end) of that.
+  void        append   (const particle_array& that);
+  void        swap     (std::size_t lhs, std::size_t rhs);
+
+  vector4     position    (std::size_t index) const;
+  void        set_position(std::size_t index, const vector4& position);
+
+  // Reorders the particles such that those satisfying predicate(index) precede the others, and returns the count of the former (as std::partition).
+  template <typename predicate_type>
+  std::size_t partition(const predicate_type& predicate)
+  {
+    std::size_t first = 0, last = size();
+    while (true)
+    {
+      while (first < last &&  predicate(first    )) ++first;
+      while (first < last && !predicate(last  - 1)) --last ;
+      if (first == last)
+        return first;
+      swap(first++, --last);
+    }
+  }
+  // Removes the particles satisfying predicate(index), keeping the order of the others (as std::remove_if and erase).
+  template <typename predicate_type>
+  void        remove_if(const predicate_type& predicate)
+  {
+    std::size_t target = 0;
+    for (std::size_t index = 0; index < size(); ++index)
+    {
+      if (predicate(index))
+        continue;
+      if (target != index)
+        set(target, get(index));
+      ++target;
+    }
+    resize(target);
+  }
+
+  std::vector<scalar>   x                    {};
+  std::vector<scalar>   y                    {};
+  std::vector<scalar>   z                    {};
+  std::vector<scalar>   t                    {}; // The fourth component of the position, i.e. the time in unsteady vector fields.
+  std::vector<integer>  remaining_iterations {};
+  std::vector<integer>  vector_field_index   {};
+
+  std::vector<integer>  original_rank        {};
+  std::vector<ivector3> original_voxel       {};
+};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,88 @@
+#ifndef PA_MATH_PARTICLE_OUTBOX_HPP
+#define PA_MATH_PARTICLE_OUTBOX_HPP
+
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <tbb/tbb.h>
+
+#include <pa/math/particle.hpp>
+#include <pa/math/particle_array.hpp>
+#include <pa/math/types.hpp>
+
+namespace pa
+{
+// Particles filed under a key (e.g. the rank of a neighbor) by many threads at once, without locking:
+// each thread appends to buffers of its own, which merge() moves into the shared array of each key once the threads are done (e.g. at the end of a round).
+// Keys are added up front by emplace. Particles filed under a key which was not added are dropped, as by a failed find on a map.
+class particle_outbox
+{
+public:
+  using entry = std::pair<integer, particle_array>;
+
+  particle_outbox           ()                             = default;
+  particle_outbox           (const particle_outbox&  that) = default;
+  particle_outbox           (      particle_outbox&& temp) = default;
+  virtual ~particle_outbox  ()                             = default;
+  particle_outbox& operator=(const particle_outbox&  that) = default;
+  particle_outbox& operator=(      particle_outbox&& temp) = default;
+
+  // Not thread-safe. Keys must be unique.
+  void                       emplace(const integer key, particle_array particles = {})
+  {
+    entries_.emplace_back(key, std::move(particles));
+  }
+  std::optional<std::size_t> slot   (const integer key) const
+  {
+    // Keys 0, 1, ... added in order (e.g. all ranks) are their own slots.
+    if (key >= 0 && std::size_t(key) < entries_.size() && entries_[key].first == key)
+      return std::size_t(key);
+    for (std::size_t index = 0; index < entries_.size(); ++index)
+      if (entries_[index].first == key)
+        return index;
+    return std::nullopt;
+  }
+
+  // Thread-safe with respect to each other.
+  bool                       push   (const integer key, const particle& particle)
+  {
+    const auto index = slot(key);
+    if (!index)
+      return false;
+
+    auto& buffers = buffers_.local();
+    if (buffers.size() < entries_.size())
+      buffers.resize(entries_.size());
+    buffers[*index].push_back(particle);
+    return true;
+  }
+
+  // Not thread-safe. Must precede the iteration over the entries.
+  void                       merge  ()
+  {
+    for (auto& buffers : buffers_)
+      for (std::size_t index = 0; index < buffers.size(); ++index)
+      {
+        auto& target = entries_[index].second;
+        if (target.empty())
+          target = std::move(buffers[index]);
+        else
+          target.append(buffers[index]);
+        buffers[index].clear();
+      }
+  }
+
+  auto                       begin  ()       { return entries_.begin(); }
+  auto                       begin  () const { return entries_.begin(); }
+  auto                       end    ()       { return entries_.end  (); }
+  auto                       end    () const { return entries_.end  (); }
+
+protected:
+  std::vector<entry>                                          entries_ {};
+  tbb::enumerable_thread_specific<std::vector<particle_array>> buffers_ {}; // Per thread, one buffer per slot.
+};
+}
+
+#endif
\ No newline at end of file
@@ -1,8 +1,13 @@
 #ifndef PA_MATH_SCALAR_FIELD_HPP
 #define PA_MATH_SCALAR_FIELD_HPP
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
 #include <boost/multi_array.hpp>
 
+#include <pa/math/bricked_array.hpp>
 #include <pa/math/types.hpp>
 #include <pa/export.hpp>
 
@@ -10,10 +15,26 @@ namespace pa
 {
 struct PA_EXPORT scalar_field
 {
-  boost::multi_array<scalar, 3> data    {};
-  vector3                       offset  {};
-  vector3                       size    {};
-  vector3                       spacing {};
+  enum class layout
+  {
+    linear   , // Row-major, stored in data.
+    sparse   , // Morton-ordered bricks where all-zero bricks share a single brick, stored in sparse_data.
+    mapped   , // Bricks of a preprocessed brick file, memory-mapped without copying, stored in sparse_data.
+    linear_8 , // Row-major 8-bit unsigned integers as stored in the file, stored in data_8 (4x smaller).
+    linear_16  // Row-major 16-bit unsigned integers as stored in the file, stored in data_16 (2x smaller).
+  };
+
+  std::array<std::size_t, 3>           shape      () const;
+  scalar                               at         (std::size_t x, std::size_t y, std::size_t z) const; // Integers are converted without normalization.
+
+  layout                               data_layout = layout::linear;
+  boost::multi_array<scalar, 3>        data        {};
+  boost::multi_array<std::uint8_t , 3> data_8      {};
+  boost::multi_array<std::uint16_t, 3> data_16     {};
+  bricked_array<scalar>                sparse_data {};
+  vector3                              offset      {};
+  vector3                              size        {};
+  vector3                              spacing     {};
 };
 }
 
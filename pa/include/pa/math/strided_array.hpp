@@ -0,0 +1,68 @@
+#ifndef PA_MATH_STRIDED_ARRAY_HPP
+#define PA_MATH_STRIDED_ARRAY_HPP
+
+#include <array>
+#include <cstddef>
+
+#include <Eigen/Core>
+
+namespace pa
+{
+// Three dimensional array of vectors viewing read-only memory owned elsewhere (e.g. by a simulation) without copying.
+// Each component is addressed through its own pointer and element strides, which covers interleaved and separate components as well as padded buffers.
+// The memory must outlive the view.
+template <typename type, std::size_t components = 3>
+class strided_array
+{
+public:
+  using size_type    = std::size_t;
+  using shape_type   = std::array<size_type     , 3>;
+  using stride_type  = std::array<std::ptrdiff_t, 3>;
+  using pointer_type = std::array<const type*   , components>;
+  using value_type   = Eigen::Matrix<type, components, 1>;
+
+  // Component c of the element (x, y, z) is pointers[c][x * strides[0] + y * strides[1] + z * strides[2]].
+  void              view        (const shape_type& shape, const pointer_type& pointers, const stride_type& strides)
+  {
+    shape_    = shape   ;
+    pointers_ = pointers;
+    strides_  = strides ;
+  }
+  void              reset       ()
+  {
+    shape_    = {0, 0, 0};
+    pointers_ = {};
+    strides_  = {0, 0, 0};
+  }
+
+  value_type        operator()  (const size_type x, const size_type y, const size_type z) const
+  {
+    const auto index = std::ptrdiff_t(x) * strides_[0] + std::ptrdiff_t(y) * strides_[1] + std::ptrdiff_t(z) * strides_[2];
+
+    value_type value;
+    for (size_type i = 0; i < components; ++i)
+      value[i] = pointers_[i][index];
+    return value;
+  }
+
+  const shape_type& shape       () const
+  {
+    return shape_;
+  }
+  size_type         num_elements() const
+  {
+    return shape_[0] * shape_[1] * shape_[2];
+  }
+  bool              empty       () const
+  {
+    return pointers_[0] == nullptr;
+  }
+
+protected:
+  shape_type   shape_    {0, 0, 0};
+  pointer_type pointers_ {};
+  stride_type  strides_  {0, 0, 0};
+};
+}
+
+#endif
\ No newline at end of file
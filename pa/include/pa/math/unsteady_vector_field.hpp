@@ -0,0 +1,31 @@
+#ifndef PA_MATH_UNSTEADY_VECTOR_FIELD_HPP
+#define PA_MATH_UNSTEADY_VECTOR_FIELD_HPP
+
+#include <array>
+
+#include <pa/math/types.hpp>
+#include <pa/math/vector_field.hpp>
+#include <pa/export.hpp>
+
+namespace pa
+{
+// Time interval between two resident time slices of a time-varying vector field. The fourth component of a position is its time.
+// Both slices must share the offset, size and spacing.
+struct PA_EXPORT unsteady_vector_field
+{
+  using sample_cache = std::array<vector_field::sample_cache, 2>;
+
+  bool    contains   (const vector4& position) const; // Within the spatial bounds, regardless of time.
+  bool    expired    (const vector4& position) const; // Beyond the end of the interval.
+  bool    empty      (const vector4& position) const;
+  vector3 interpolate(const vector4& position) const;
+  vector3 interpolate(const vector4& position, sample_cache& cache) const;
+
+  const vector_field* start      = nullptr;
+  const vector_field* end        = nullptr;
+  scalar              start_time = 0.0f;
+  scalar              end_time   = 1.0f;
+};
+}
+
+#endif
\ No newline at end of file
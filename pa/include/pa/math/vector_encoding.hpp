@@ -0,0 +1,77 @@
+#ifndef PA_MATH_VECTOR_ENCODING_HPP
+#define PA_MATH_VECTOR_ENCODING_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+#include <Eigen/Core>
+
+#include <pa/math/types.hpp>
+
+namespace pa
+{
+// Half precision vector (6 bytes). Components are rounded to nearest even: the relative error per component is at most 2^-11,
+// the absolute error below 2^-14 is at most 2^-25. Magnitudes above 65504 are not representable.
+struct half_vector3
+{
+  static half_vector3 encode(const vector3& vector)
+  {
+    return half_vector3 {{Eigen::half(vector[0]), Eigen::half(vector[1]), Eigen::half(vector[2])}};
+  }
+  vector3             decode() const
+  {
+    return vector3(static_cast<scalar>(components[0]), static_cast<scalar>(components[1]), static_cast<scalar>(components[2]));
+  }
+
+  std::array<Eigen::half, 3> components;
+};
+
+// Unit direction in 16-bit octahedral encoding (8 bits per axis) and magnitude in 8 bits, linear in [0, magnitude_scale] (3 bytes).
+// The angular error of the direction is below 1 degree, the absolute error of the magnitude is magnitude_scale / 510 (up to float
+// rounding). Vectors shorter than magnitude_scale / 510 decode to zero.
+struct octahedral_vector3
+{
+  static octahedral_vector3 encode(const vector3& vector, const scalar magnitude_scale)
+  {
+    const auto quantize  = [ ] (const scalar value) { return std::uint8_t(std::lround(std::clamp(value, scalar(0), scalar(1)) * scalar(255))); };
+    const auto l1_norm   = vector.cwiseAbs().sum();
+    const auto magnitude = magnitude_scale > scalar(0) ? vector.norm() / magnitude_scale : scalar(0);
+    if (l1_norm == scalar(0))
+      return octahedral_vector3 {{quantize(scalar(0.5)), quantize(scalar(0.5)), 0}};
+
+    vector2 projected = vector.head<2>() / l1_norm;
+    if (vector[2] < scalar(0))
+      projected = vector2(
+        (scalar(1) - std::abs(projected[1])) * (projected[0] >= scalar(0) ? scalar(1) : scalar(-1)),
+        (scalar(1) - std::abs(projected[0])) * (projected[1] >= scalar(0) ? scalar(1) : scalar(-1)));
+
+    return octahedral_vector3 {{
+      quantize(projected[0] * scalar(0.5) + scalar(0.5)),
+      quantize(projected[1] * scalar(0.5) + scalar(0.5)),
+      quantize(magnitude)}};
+  }
+  vector3                   decode(const scalar magnitude_scale) const
+  {
+    if (bytes[2] == 0)
+      return vector3::Zero();
+
+    vector3 direction(
+      scalar(bytes[0]) / scalar(127.5) - scalar(1),
+      scalar(bytes[1]) / scalar(127.5) - scalar(1),
+      scalar(0));
+    direction[2] = scalar(1) - std::abs(direction[0]) - std::abs(direction[1]);
+    if (direction[2] < scalar(0))
+      direction.head<2>() = vector2(
+        (scalar(1) - std::abs(direction[1])) * (direction[0] >= scalar(0) ? scalar(1) : scalar(-1)),
+        (scalar(1) - std::abs(direction[0])) * (direction[1] >= scalar(0) ? scalar(1) : scalar(-1)));
+    
+    return direction.normalized() * (scalar(bytes[2]) / scalar(255) * magnitude_scale);
+  }
+
+  std::array<std::uint8_t, 3> bytes;
+};
+}
+
+#endif
\ No newline at end of file
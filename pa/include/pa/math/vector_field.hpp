@@ -1,26 +1,74 @@
 #ifndef PA_MATH_VECTOR_FIELD_HPP
 #define PA_MATH_VECTOR_FIELD_HPP
 
+#include <array>
+#include <cstddef>
 #include <memory>
 
 #include <boost/multi_array.hpp>
 
+#include <pa/math/bricked_array.hpp>
+#include <pa/math/strided_array.hpp>
 #include <pa/math/tensor_field.hpp>
 #include <pa/math/types.hpp>
+#include <pa/math/vector_encoding.hpp>
 #include <pa/export.hpp>
 
 namespace pa
 {
 struct PA_EXPORT vector_field
 {
+  enum class layout
+  {
+    linear            , // Row-major, stored in data.
+    bricked           , // Morton-ordered bricks, stored in bricked_data.
+    bricked_half      , // Morton-ordered bricks of half precision vectors, stored in half_data (2x smaller).
+    bricked_octahedral, // Morton-ordered bricks of octahedral directions and 8-bit magnitudes, stored in octahedral_data (4x smaller).
+    sparse            , // Morton-ordered bricks where all-zero bricks share a single brick, stored in bricked_data.
+    mapped            , // Bricks of a preprocessed brick file, memory-mapped without copying, stored in bricked_data.
+    external          , // Strided single precision memory owned elsewhere (e.g. a simulation), viewed without copying, stored in external_data.
+    external_double     // Strided double precision memory owned elsewhere, viewed without copying and converted on access, stored in double_data.
+  };
+
+  // Keeps the corners of the last sampled cell, so that consecutive samples within the same cell skip the corner fetches.
+  // Kept per particle by the tracers; must not be shared across vector fields.
+  struct PA_EXPORT sample_cache
+  {
+    ivector3               multi_index = ivector3::Constant(-1);
+    std::array<vector3, 8> corners     {};
+    std::size_t            hits        = 0;
+    std::size_t            misses      = 0;
+  };
+
   bool                          contains   (const vector4& position) const;
   vector3                       interpolate(const vector4& position) const;
-  std::unique_ptr<tensor_field> gradient   ();
+  vector3                       interpolate(const vector4& position, sample_cache& cache) const;
+  void                          gather     (const ivector3& multi_index, std::array<vector3, 8>& corners) const; // Corner order is zyx: c000, c001, c010, ..., c111.
+  std::unique_ptr<tensor_field> gradient   ();                                             // Jacobian at each voxel, see gradient_stencil.
+  std::array<std::size_t, 3>    shape      () const;
+  vector3                       at         (std::size_t x, std::size_t y, std::size_t z) const; // Decoded vector at the voxel.
+  vector3                       origin     () const;                                             // Position of the first voxel, i.e. the offset less the lower ghost layers.
+  std::size_t                   byte_size  () const;                                             // Memory held by the voxels and the macro grid, excluding memory-mapped bricks and external memory.
+
+  // The macro grid stores the maximum magnitude over each macro cell of macro_cell_size^3 cells (corners included).
+  // A position within a macro cell of zero magnitude interpolates to zero, which allows skipping empty space without interpolation.
+  void                          compute_macro_grid(std::size_t cell_size = 8);
+  bool                          empty             (const vector4& position) const; // False if the macro grid is not computed.
   
-  boost::multi_array<vector3, 3> data    {};
-  vector3                        offset  {};
-  vector3                        size    {};
-  vector3                        spacing {};
+  layout                                 data_layout       = layout::linear;
+  boost::multi_array<vector3, 3>         data              {};
+  bricked_array<vector3>                 bricked_data      {};
+  bricked_array<half_vector3>            half_data         {};
+  bricked_array<octahedral_vector3>      octahedral_data   {};
+  strided_array<scalar>                  external_data     {};
+  strided_array<double>                  double_data       {};
+  scalar                                 magnitude_scale   = 1.0f; // Maximum magnitude, used by the octahedral layout.
+  boost::multi_array<scalar, 3>          macro_grid        {};
+  std::size_t                            macro_cell_size   = 8;
+  vector3                                offset            {};     // Owned region, excluding ghost layers.
+  vector3                                size              {};
+  vector3                                spacing           {};
+  ivector3                               lower_ghost_width = ivector3::Zero(); // Ghost layers preceding the owned region, filled by the halo_exchanger.
 };
 }
 
@@ -0,0 +1,53 @@
+#ifndef PA_STAGES_BLOCK_CACHE_HPP
+#define PA_STAGES_BLOCK_CACHE_HPP
+
+#include <array>
+#include <cstddef>
+#include <list>
+#include <optional>
+
+#include <pa/math/types.hpp>
+#include <pa/math/vector_field.hpp>
+#include <pa/stages/data_io.hpp>
+#include <pa/export.hpp>
+
+namespace pa
+{
+// Pages the neighbor vector fields in on demand and evicts the least recently used ones beyond a memory budget.
+// Acquired blocks are pinned until released, hence the budget may be exceeded while more blocks are in use than it allows.
+class PA_EXPORT block_cache
+{
+public:
+  explicit block_cache  (data_io* data_io);
+  block_cache           (const block_cache&  that) = delete ;
+  block_cache           (      block_cache&& temp) = delete ;
+  virtual ~block_cache  ()                         = default;
+  block_cache& operator=(const block_cache&  that) = delete ;
+  block_cache& operator=(      block_cache&& temp) = delete ;
+
+  void                                        set_memory_budget (std::size_t memory_budget ); // In bytes, 0 for unlimited.
+  void                                        set_neighbor_depth(integer     neighbor_depth); // See data_io::load_neighbor_vector_fields.
+
+  const vector_field&                         acquire           (std::size_t index);           // Loads the neighbor vector field if absent and pins it.
+  void                                        release           ();                            // Unpins all blocks.
+  void                                        clear             ();
+
+  std::array<std::optional<vector_field>, 6>* vector_fields     ();
+  std::size_t                                 memory_usage      () const;
+  std::array<std::size_t, 2>                  statistics        () const;                      // Loads and evictions (in this order) since the last clear.
+
+protected:
+  void                                        evict             ();
+
+  data_io*                                   data_io_        = nullptr;
+  std::size_t                                memory_budget_  = 0;
+  integer                                    neighbor_depth_ = 0;
+  std::array<std::optional<vector_field>, 6> vector_fields_  {};
+  std::array<bool, 6>                        pinned_         {};
+  std::list<std::size_t>                     recently_used_  {}; // Most recently used first.
+  std::size_t                                loads_          = 0;
+  std::size_t                                evictions_      = 0;
+};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef PA_STAGES_BLOCK_SHARER_HPP
+#define PA_STAGES_BLOCK_SHARER_HPP
+
+#include <array>
+#include <optional>
+
+#include <boost/mpi.hpp>
+#include <mpi.h>
+
+#include <pa/math/types.hpp>
+#include <pa/math/vector_field.hpp>
+#include <pa/stages/data_io.hpp>
+#include <pa/stages/partitioner.hpp>
+#include <pa/export.hpp>
+
+namespace pa
+{
+// Shares the local vector fields of the ranks on the same node through an MPI-3 shared memory window, so that each block is loaded once per node.
+// Each rank loads its local block straight into its segment of the window, neighbor blocks owned by ranks on the same node are viewed in place, the others are loaded from the file.
+// Requires a dense bricked layout (bricked, bricked_half or bricked_octahedral) and no ghost layers, since the shared bricks are read-only.
+class PA_EXPORT block_sharer
+{
+public:
+  explicit block_sharer  (partitioner* partitioner, data_io* data_io);
+  block_sharer           (const block_sharer&  that) = delete ;
+  block_sharer           (      block_sharer&& temp) = delete ;
+  virtual ~block_sharer  ();
+  block_sharer& operator=(const block_sharer&  that) = delete ;
+  block_sharer& operator=(      block_sharer&& temp) = delete ;
+
+  // Loads the local vector field into the window and the neighbor vector fields (if not null) as above. A non-zero depth applies to the neighbors loaded from the file.
+  // The vector fields view the window until the next load or release. Collective.
+  void                      load              (std::optional<vector_field>* local_vector_field, std::array<std::optional<vector_field>, 6>* neighbor_vector_fields = nullptr, integer depth = 0);
+  // Resets the vector fields of the last load and frees the window. Collective.
+  void                      release           ();
+
+  boost::mpi::communicator* node_communicator ();
+  std::size_t               shared_neighbors  () const; // Neighbors of the last load viewed in place.
+
+protected:
+  partitioner*                                partitioner_            = nullptr;
+  data_io*                                    data_io_                = nullptr;
+  boost::mpi::communicator                    node_communicator_      {};
+  MPI_Win                                     window_                 = MPI_WIN_NULL;
+  std::optional<vector_field>*                local_vector_field_     = nullptr;
+  std::array<std::optional<vector_field>, 6>* neighbor_vector_fields_ = nullptr;
+  std::size_t                                 shared_neighbors_       = 0;
+};
+}
+
+#endif
\ No newline at end of file
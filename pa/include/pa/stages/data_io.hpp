@@ -2,11 +2,16 @@
 #define PA_STAGES_DATA_LOADER_HPP
 
 #include <array>
+#include <functional>
+#include <future>
+#include <map>
 #include <memory>
 #include <optional>
+#include <string>
 
 #include <highfive/H5File.hpp>
 
+#include <pa/math/brick_file.hpp>
 #include <pa/math/integral_curves.hpp>
 #include <pa/math/types.hpp>
 #include <pa/math/scalar_field.hpp>
@@ -27,21 +32,73 @@ public:
   data_io& operator=(      data_io&& temp) = delete ;
 
   void                                       set_file                   (const std::string& filepath);
+  void                                       set_scalar_field_layout    (scalar_field::layout layout); // The linear layouts load 8 and 16-bit unsigned integer datasets as linear_8 and linear_16, others as linear.
+  void                                       set_vector_field_layout    (vector_field::layout layout);
+  vector_field::layout                       vector_field_layout        () const;
+  // Level 0 is the dataset itself, level n > 0 the datasets in the group levels/n, downsampled n times by a factor of 2 (see pars_preprocess).
+  // The spacing is scaled accordingly, so that all levels share the same coordinates.
+  void                                       set_level                  (std::size_t          level );
+  std::size_t                                load_level_count           ();
+  // Loads the local vector field through reader ranks: the ranks are divided into reader_count groups, whose first rank reads the block of each rank of the group
+  // in large slabs aligned to the alignment (the chunks of the dataset if zero), optionally collectively (parallel HDF5), and sends each rank its block, which the rank receives slab by slab
+  // straight into its vector field. Zero readers disables aggregation. Applies to the collective load_local_vector_field() in all layouts but mapped. Neighbor vector fields are loaded independently.
+  void                                       set_aggregation            (std::size_t reader_count, std::size_t alignment = 0, bool collective = false);
   ivector3                                   load_dimensions            ();
   std::optional<scalar_field>                load_local_scalar_field    (const std::string& name    );
   std::optional<vector_field>                load_local_vector_field    ();
-  std::array<std::optional<vector_field>, 6> load_neighbor_vector_fields();
+  // Loads the local vector field as above, placing the bricks of a dense bricked layout (bricked, bricked_half or bricked_octahedral) in the storage instead of allocating them,
+  // e.g. in a shared memory window. The storage holds bricked_array::storage_size of the ghosted block size elements and outlives the vector field. Collective.
+  std::optional<vector_field>                load_local_vector_field_into(void* storage);
+
+  // Time-varying vector fields are stored as the datasets 0, 1, ... of the group time_vectors, with an optional time_spacing attribute.
+  std::size_t                                load_time_slice_count      ();
+  scalar                                     load_time_spacing          ();
+  std::optional<vector_field>                load_local_vector_field    (std::size_t        time_slice);
+  // Loads the time slice as above on a background thread. Any other call waits for the load to complete.
+  std::future<std::optional<vector_field>>   load_local_vector_field_async(std::size_t      time_slice);
+  // A non-zero depth only loads the slab of each neighbor block within depth voxels of the shared face.
+  std::array<std::optional<vector_field>, 6> load_neighbor_vector_fields(integer depth = 0);
+  std::optional<vector_field>                load_neighbor_vector_field (std::size_t index, integer depth = 0);
+  // Loads the neighbor vector fields one after the other on a background thread. The future of a slot becomes ready once its vector field is loaded.
+  // The vector fields must outlive the load. Any other call waits for the load to complete.
+  std::array<std::shared_future<void>, 6>    load_neighbor_vector_fields_async(std::array<std::optional<vector_field>, 6>* vector_fields, integer depth = 0);
+  // Loads the block [offset, offset + size) of the vector field (and the one voxel ghost region on its positive sides) from a brick file in the cache directory, e.g. on node-local scratch storage.
+  // The brick file is created from the dataset on first use and kept for subsequent loads. The vector field has the mapped layout, i.e. is paged in from the brick file.
+  std::optional<vector_field>                load_vector_field_block    (const ivector3& offset, const ivector3& size, const std::string& cache_directory);
+  // Loads the block as above on a background thread. Any other call waits for the load to complete.
+  std::future<std::optional<vector_field>>   load_vector_field_block_async(const ivector3& offset, const ivector3& size, const std::string& cache_directory);
+  // False if the loads can not run on a background thread, in which case the asynchronous loads complete before they return.
+  bool                                       can_load_async             () const;
+  vector3                                    load_spacing               ();
 
   void                                       save_ftle_field            (const std::string& name  , scalar_field*                 ftle_field     );
 
   void                                       save_integral_curves       (const std::string& prefix, std::vector<integral_curves>* integral_curves);
 
 protected:
+  using plane_reader = std::function<void(std::size_t begin, std::size_t count, scalar* destination)>; // Reads the planes [begin, begin + count) of a region into the destination (row-major).
+
   void                                       load_scalar_field          (const std::string& name  , const partitioner::rank_info& rank_info, std::optional<scalar_field>& scalar_field);
-  void                                       load_vector_field          (                           const partitioner::rank_info& rank_info, std::optional<vector_field>& vector_field);
+  void                                       load_vector_field          (const std::string& name  , const partitioner::rank_info& rank_info, std::optional<vector_field>& vector_field, bool aggregated = false, void* storage = nullptr); // Reads through aggregate_block if aggregated. Places dense bricks in the storage if given.
+  void                                       load_neighbor_vector_field (std::size_t        index , integer                       depth    , std::optional<vector_field>& vector_field);
+  void                                       load_vector_field_block    (const ivector3&    offset, const ivector3&               size     , const std::string& cache_directory, std::optional<vector_field>& vector_field);
+  // Calls load with a reader of the planes of the local region, which it reads in order, in brick slabs (see bricked_array::size) or at once. Collective.
+  void                                       aggregate_block            (const std::string& name  , const std::function<void(const plane_reader&)>& load);
+  const brick_file&                          load_brick_file            (const std::string& name  ); // Maps <file>.<name>.bricks, created by pars_preprocess.
+  std::string                                level_name                 (const std::string& name  ) const; // The path of the dataset or group at the current level.
+  void                                       wait                       ();                          // Waits for the pending background load, if any.
 
-  partitioner*                    partitioner_ = nullptr;
-  std::unique_ptr<HighFive::File> file_        = nullptr;
+  partitioner*                                       partitioner_         = nullptr;
+  std::string                                        filepath_            {};
+  std::unique_ptr<HighFive::File>                    file_                = nullptr;
+  std::map<std::string, std::unique_ptr<brick_file>> brick_files_         {};
+  scalar_field::layout                               scalar_field_layout_ = scalar_field::layout::linear;
+  vector_field::layout                               vector_field_layout_ = vector_field::layout::linear;
+  std::size_t                                        level_               = 0;
+  std::size_t                                        reader_count_        = 0;
+  std::size_t                                        alignment_           = 0;
+  bool                                               collective_          = false;
+  std::future<void>                                  pending_             {};
 };
 }
 
@@ -0,0 +1,46 @@
+#ifndef PA_STAGES_DERIVED_FIELD_GENERATOR_HPP
+#define PA_STAGES_DERIVED_FIELD_GENERATOR_HPP
+
+#include <cstddef>
+#include <memory>
+
+#include <pa/math/scalar_field.hpp>
+#include <pa/math/vector_field.hpp>
+#include <pa/export.hpp>
+
+namespace pa
+{
+// Derives a scalar field from the local vector field in memory, in place of a scalar field read from the dataset.
+// The result covers the same voxels as a loaded scalar field (the block and the voxel shared with each positive neighbor), while the derivatives
+// use the ghost layers of the vector field (if any) so that the blocks agree at their borders. The block is traversed in tiles of rows along z.
+class PA_EXPORT derived_field_generator
+{
+public:
+  enum class mode
+  {
+    vorticity_magnitude, // Magnitude of the curl.
+    q_criterion        , // 0.5 (|Omega|^2 - |S|^2) of the antisymmetric and symmetric parts of the Jacobian.
+    divergence
+  };
+
+  explicit derived_field_generator  (mode mode = mode::vorticity_magnitude, std::size_t tile_size = 8);
+  derived_field_generator           (const derived_field_generator&  that) = delete ;
+  derived_field_generator           (      derived_field_generator&& temp) = delete ;
+  virtual ~derived_field_generator  ()                                     = default;
+  derived_field_generator& operator=(const derived_field_generator&  that) = delete ;
+  derived_field_generator& operator=(      derived_field_generator&& temp) = delete ;
+
+  void                          set_mode        (mode                mode        );
+  void                          set_tile_size   (std::size_t         tile_size   ); // Rows per tile along x and y.
+  void                          set_vector_field(const vector_field* vector_field);
+
+  std::unique_ptr<scalar_field> generate        () const;
+
+protected:
+  mode                mode_         = mode::vorticity_magnitude;
+  std::size_t         tile_size_    = 8;
+  const vector_field* vector_field_ = nullptr;
+};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef PA_STAGES_HALO_EXCHANGER_HPP
+#define PA_STAGES_HALO_EXCHANGER_HPP
+
+#include <pa/math/vector_field.hpp>
+#include <pa/stages/partitioner.hpp>
+#include <pa/export.hpp>
+
+namespace pa
+{
+// Extends the local block by the ghost layers of the partitioner, filled with the values of the neighbors over MPI rather than read from the file.
+// Axes are exchanged one after the other, so that edges and corners are forwarded through the face neighbors.
+class PA_EXPORT halo_exchanger
+{
+public:
+  explicit halo_exchanger  (partitioner* partitioner);
+  halo_exchanger           (const halo_exchanger&  that) = delete ;
+  halo_exchanger           (      halo_exchanger&& temp) = delete ;
+  virtual ~halo_exchanger  ()                            = default;
+  halo_exchanger& operator=(const halo_exchanger&  that) = delete ;
+  halo_exchanger& operator=(      halo_exchanger&& temp) = delete ;
+
+  void exchange(vector_field* vector_field); // Requires a dense layout (linear, bricked, bricked_half or bricked_octahedral). Collective.
+
+protected:
+  partitioner* partitioner_ = nullptr;
+};
+}
+
+#endif
\ No newline at end of file
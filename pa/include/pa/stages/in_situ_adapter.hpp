@@ -0,0 +1,53 @@
+#ifndef PA_STAGES_IN_SITU_ADAPTER_HPP
+#define PA_STAGES_IN_SITU_ADAPTER_HPP
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+#include <pa/math/strided_array.hpp>
+#include <pa/math/types.hpp>
+#include <pa/math/vector_field.hpp>
+#include <pa/stages/partitioner.hpp>
+#include <pa/export.hpp>
+
+namespace pa
+{
+// Couples a running simulation to the stages in place of data_io, without writing its data to disk.
+// The domain is decomposed by the partitioner as for a dataset, and each rank provides the vectors of its local region from its own memory.
+// The region is viewed in the external layouts without copying, hence the memory must outlive the vector fields and must not change while they are traced.
+class PA_EXPORT in_situ_adapter
+{
+public:
+  explicit in_situ_adapter  (partitioner* partitioner);
+  in_situ_adapter           (const in_situ_adapter&  that) = delete ;
+  in_situ_adapter           (      in_situ_adapter&& temp) = delete ;
+  virtual ~in_situ_adapter  ()                             = default;
+  in_situ_adapter& operator=(const in_situ_adapter&  that) = delete ;
+  in_situ_adapter& operator=(      in_situ_adapter&& temp) = delete ;
+
+  // Collective. Decomposes the domain without ghost layers and discards the vector field.
+  void                          set_domain             (const ivector3& domain_size, const vector3& spacing);
+  // Offset and size in voxels of the region each rank provides, i.e. its block and the one voxel shared with each positive neighbor.
+  std::pair<ivector3, ivector3> local_region           () const;
+
+  // Component c of the voxel (x, y, z) of the local region is components[c][x * strides[0] + y * strides[1] + z * strides[2]], e.g.
+  // {u, v, w} and {ny * nz, nz, 1} for separate row-major arrays, or {data, data + 1, data + 2} and {3 * ny * nz, 3 * nz, 3} for interleaved vectors.
+  void                          set_vector_field       (const std::array<const float *, 3>& components, const std::array<std::ptrdiff_t, 3>& strides);
+  void                          set_vector_field       (const std::array<const double*, 3>& components, const std::array<std::ptrdiff_t, 3>& strides);
+  bool                          has_vector_field       () const;
+
+  std::optional<vector_field>   load_local_vector_field() const; // Views the memory of the last set_vector_field.
+  vector3                       load_spacing           () const;
+
+protected:
+  partitioner*                  partitioner_   = nullptr;
+  vector3                       spacing_       = vector3::Ones();
+  vector_field::layout          layout_        = vector_field::layout::external;
+  strided_array<scalar>         external_data_ {};
+  strided_array<double>         double_data_   {};
+};
+}
+
+#endif
\ No newline at end of file
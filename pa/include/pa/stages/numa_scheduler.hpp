@@ -0,0 +1,55 @@
+#ifndef PA_STAGES_NUMA_SCHEDULER_HPP
+#define PA_STAGES_NUMA_SCHEDULER_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <tbb/tbb.h>
+
+#include <pa/math/types.hpp>
+#include <pa/math/vector_field.hpp>
+#include <pa/export.hpp>
+
+namespace pa
+{
+// Splits the work of a process across the NUMA nodes (sockets) its processors belong to.
+// Each node has a task arena whose threads are pinned to the processors of the node. The storage of a vector field is divided into one contiguous slice per node,
+// which is moved to the memory of the node by place(), and the particles sampling a slice are traced in the arena of its node (see particle_tracer::set_numa_scheduler).
+// Falls back to a single node spanning all processors if the topology is unavailable (e.g. outside Linux).
+class PA_EXPORT numa_scheduler
+{
+public:
+  explicit numa_scheduler  (std::size_t thread_count = tbb::task_scheduler_init::default_num_threads());
+  numa_scheduler           (const numa_scheduler&  that) = delete ;
+  numa_scheduler           (      numa_scheduler&& temp) = delete ;
+  virtual ~numa_scheduler  ()                            = default;
+  numa_scheduler& operator=(const numa_scheduler&  that) = delete ;
+  numa_scheduler& operator=(      numa_scheduler&& temp) = delete ;
+
+  std::size_t node_count   () const;
+
+  // Moves each slice of the storage of the vector field to the memory of its node. Memory-mapped, shared and external storage is left in place.
+  void        place        (vector_field& vector_field);
+  // The node whose slice holds the cell containing the position (clamped to the vector field).
+  std::size_t node         (const vector_field& vector_field, const vector4& position) const;
+
+  // Calls function(node) within the arena of each node concurrently and waits for all of them.
+  template <typename function_type>
+  void        for_each_node(const function_type& function)
+  {
+    const auto groups = std::make_unique<tbb::task_group[]>(arenas_.size());
+    for (std::size_t node = 0; node < arenas_.size(); ++node)
+      arenas_[node]->execute([&, node] { groups[node].run([&, node] { function(node); }); });
+    for (std::size_t node = 0; node < arenas_.size(); ++node)
+      arenas_[node]->execute([&, node] { groups[node].wait(); });
+  }
+
+protected:
+  std::vector<int>                                           node_ids_  {};
+  std::vector<std::unique_ptr<tbb::task_arena>>              arenas_    {};
+  std::vector<std::unique_ptr<tbb::task_scheduler_observer>> observers_ {}; // Pin the threads entering the arenas, hence are destroyed before them.
+};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,72 @@
+#ifndef PA_STAGES_OUT_OF_CORE_TRACER_HPP
+#define PA_STAGES_OUT_OF_CORE_TRACER_HPP
+
+#include <array>
+#include <cstddef>
+#include <future>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pa/math/integral_curves.hpp>
+#include <pa/math/particle.hpp>
+#include <pa/math/particle_array.hpp>
+#include <pa/math/types.hpp>
+#include <pa/math/vector_field.hpp>
+#include <pa/stages/data_io.hpp>
+#include <pa/stages/particle_tracer.hpp>
+#include <pa/stages/partitioner.hpp>
+#include <pa/export.hpp>
+
+namespace pa
+{
+// Traces steady vector fields whose local block exceeds the memory, by subdividing it into smaller blocks which are traced one at a time.
+// Each block keeps a queue of the particles within it. The block with the most queued particles is traced next, while the one after it is prefetched.
+// Blocks are loaded through brick files in the cache directory (see data_io::load_vector_field_block), hence at most two blocks are resident.
+// The particles are traced by the particle tracer (without load balancing) and exchanged between the ranks by its out_of_bounds_distribute.
+class PA_EXPORT out_of_core_tracer
+{
+public:
+  explicit out_of_core_tracer  (partitioner* partitioner, data_io* data_io, particle_tracer* particle_tracer);
+  out_of_core_tracer           (const out_of_core_tracer&  that) = delete ;
+  out_of_core_tracer           (      out_of_core_tracer&& temp) = delete ;
+  virtual ~out_of_core_tracer  ()                                = default;
+  out_of_core_tracer& operator=(const out_of_core_tracer&  that) = delete ;
+  out_of_core_tracer& operator=(      out_of_core_tracer&& temp) = delete ;
+
+  void                          set_block_size     (const ivector3&    block_size     ); // Clamped to the local block size.
+  void                          set_cache_directory(const std::string& cache_directory);
+  void                          set_prefetch       (bool               prefetch       );
+
+  std::vector<integral_curves>  trace              (particle_array        particles);
+
+  // Block loads and traced particles (in this order) of the last trace.
+  std::array<std::size_t, 2>    statistics         () const;
+
+protected:
+  std::optional<std::size_t>    trace_block        (std::size_t index, std::vector<integral_curves>& integral_curves, particle_tracer::round_info& outgoing); // Returns the block to trace next, if any.
+  void                          enqueue            (const particle& particle, particle_tracer::round_info& outgoing);
+  std::optional<std::size_t>    block_index        (const vector4&  position) const; // Empty if the position is outside the local block.
+  std::pair<ivector3, ivector3> block_region       (std::size_t     index   ) const; // Offset and size in voxels.
+  std::optional<std::size_t>    most_queued        () const;                         // Empty if all queues are empty.
+
+  partitioner*                               partitioner_        = nullptr;
+  data_io*                                   data_io_            = nullptr;
+  particle_tracer*                           particle_tracer_    = nullptr;
+  ivector3                                   block_size_         = ivector3::Constant(256);
+  std::string                                cache_directory_    = "/tmp";
+  bool                                       prefetch_           = true;
+
+  vector3                                    spacing_            {};
+  ivector3                                   clamped_block_size_ {};
+  ivector3                                   block_counts_       {};
+  std::vector<particle_array>                queues_             {};
+  std::optional<vector_field>                block_              {};
+  std::future<std::optional<vector_field>>   next_block_         {};
+  std::size_t                                loads_              = 0;
+  std::size_t                                traced_             = 0;
+};
+}
+
+#endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define PA_STAGES_PARTICLE_ADVECTOR_HPP
 
 #include <array>
+#include <atomic>
 #include <optional>
 #include <vector>
 
@@ -9,8 +10,11 @@
 
 #include <pa/math/integrators.hpp>
 #include <pa/math/particle.hpp>
+#include <pa/math/particle_array.hpp>
+#include <pa/math/particle_outbox.hpp>
 #include <pa/math/types.hpp>
 #include <pa/math/vector_field.hpp>
+#include <pa/stages/particle_transport.hpp>
 #include <pa/stages/partitioner.hpp>
 #include <pa/export.hpp>
 
@@ -19,7 +23,7 @@ namespace pa
 class PA_EXPORT particle_advector
 {
 public:
-  using particle_map = tbb::concurrent_hash_map<integer, std::vector<particle>>; // TODO: Switch to an array of concurrent vectors and use partitioner indices for ranks.
+  using particle_map = particle_outbox; // Merged at the end of advect.
   
   explicit particle_advector  (partitioner* partitioner);
   particle_advector           (const particle_advector&  that) = delete ;
@@ -31,21 +35,34 @@ public:
   void         set_vector_field        (vector_field*             vector_field);
   void         set_integrator          (const variant_integrator& integrator  );
   void         set_step_size           (const scalar              step_size   );
+  void         set_packet_mode         (const bool                packet_mode );
                                                                               
-  void         advect                  (std::vector<particle>&    particles   );
+  void         advect                  (particle_array&           particles   );
 
   // Advect sub-methods for separate benchmarking.
   particle_map create_neighborhood_map ();
-  void         advect                  (      std::vector<particle>& active_particles, std::vector<std::vector<particle>>& inactive_particles,       particle_map& neighborhood_map);
-  void         out_of_bounds_distribute(      std::vector<particle>& active_particles,                                                         const particle_map& neighborhood_map);
-  bool         check_completion        (const std::vector<particle>& active_particles);
+  void         advect                  (      particle_array&        active_particles, std::vector<particle_array>&        inactive_particles,       particle_map& neighborhood_map);
+  void         out_of_bounds_distribute(      particle_array&        active_particles,                                                         const particle_map& neighborhood_map);
+  bool         check_completion        (const particle_array&        active_particles);
+
+  // Sample cache hits and misses (in this order) accumulated by advect since the last reset.
+  std::array<std::size_t, 2> sample_cache_statistics      () const;
+  void                       reset_sample_cache_statistics();
 
 protected:
+  void         advect_particles        (      particle_array&        active_particles, particle_outbox&                    inactive_particles,       particle_map& neighborhood_map);
+  void         advect_packets          (      particle_array&        active_particles, particle_outbox&                    inactive_particles,       particle_map& neighborhood_map);
+
   partitioner*       partitioner_  = nullptr;
+  particle_transport transport_    ;
 
   vector_field*      vector_field_ = nullptr;
   variant_integrator integrator_   = euler_integrator();
   scalar             step_size_    = 1.0f;
+  bool               packet_mode_  = false;
+
+  std::atomic<std::size_t> sample_cache_hits_   {0};
+  std::atomic<std::size_t> sample_cache_misses_ {0};
 };
 }
 
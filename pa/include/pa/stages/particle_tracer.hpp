@@ -2,8 +2,10 @@
 #define PA_STAGES_PARTICLE_TRACER_HPP
 
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <future>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -13,8 +15,14 @@
 #include <pa/math/integral_curves.hpp>
 #include <pa/math/integrators.hpp>
 #include <pa/math/particle.hpp>
+#include <pa/math/particle_array.hpp>
+#include <pa/math/particle_outbox.hpp>
 #include <pa/math/types.hpp>
+#include <pa/math/unsteady_vector_field.hpp>
 #include <pa/math/vector_field.hpp>
+#include <pa/stages/block_cache.hpp>
+#include <pa/stages/numa_scheduler.hpp>
+#include <pa/stages/particle_transport.hpp>
 #include <pa/stages/partitioner.hpp>
 #include <pa/export.hpp>
 
@@ -25,7 +33,7 @@ class PA_EXPORT particle_tracer
 public:
   struct PA_EXPORT round_info
   {
-    using particle_map = tbb::concurrent_hash_map<integer, std::vector<particle>>; // TODO: Switch to an array of concurrent vectors and use partitioner indices for ranks.
+    using particle_map = particle_outbox; // Merged at the end of trace and load_balance_collect.
 
     std::size_t  maximum_remaining_iterations    ;
     std::size_t  vertices_per_integral_curve     ;
@@ -34,6 +42,8 @@ public:
     std::size_t  integral_curve_count            ;
     particle_map out_of_bounds_particles         ;
     particle_map neighbor_out_of_bounds_particles;
+    tbb::concurrent_vector<particle> expired_particles; // Particles reaching the end of the unsteady vector field's interval.
+    tbb::concurrent_vector<particle> returned_particles; // Particles handed back by a neighbor while within the local block (i.e. out of the inner face of its slab), traced on locally.
   };
 
   explicit particle_tracer  (partitioner* partitioner);
@@ -44,30 +54,53 @@ public:
   particle_tracer& operator=(      particle_tracer&& temp) = delete ;
 
   void                         set_local_vector_field    (std::optional<vector_field>*                local_vector_field    );
-  void                         set_neighbor_vector_fields(std::array<std::optional<vector_field>, 6>* neighbor_vector_fields);
+  void                         set_neighbor_vector_fields(std::array<std::optional<vector_field>, 6>* neighbor_vector_fields, const std::array<std::shared_future<void>, 6>& loaded = {}); // Slots with a valid loaded future are waited for when first needed.
   void                         set_integrator            (const variant_integrator&                   integrator            );
   void                         set_step_size             (const scalar                                step_size             );
+  void                         set_packet_mode           (const bool                                  packet_mode           );
+  void                         set_unsteady_vector_field (const unsteady_vector_field*                unsteady_vector_field );
+  void                         set_neighbor_depth        (const integer                               neighbor_depth        ); // Depth of the neighbor slabs (0 for full blocks). Restricts the particles handed over by load balancing to the slab held by the neighbor.
+  void                         set_block_cache           (block_cache*                                block_cache           ); // Pages the neighbor vector fields in when first needed each round, instead of the neighbor vector fields set above.
+  void                         set_numa_scheduler        (numa_scheduler*                             numa_scheduler        ); // Traces the particles in the arena of the node holding the slice of the vector field they start in.
                                                        
-  std::vector<integral_curves> trace                     (std::vector<particle>                       particles             ); 
+  std::vector<integral_curves> trace                     (particle_array                              particles             ); 
 
   // Trace sub-methods for separate benchmarking.
-  void                         load_balance_distribute   (      std::vector<particle>& particles                                                                                   );
-  round_info                   compute_round_info        (const std::vector<particle>& particles, const std::vector<integral_curves>& integral_curves                              );
+  void                         load_balance_distribute   (      particle_array&        particles                                                                                   );
+  round_info                   compute_round_info        (const particle_array&        particles, const std::vector<integral_curves>& integral_curves                              );
   void                         allocate                  (                                              std::vector<integral_curves>& integral_curves, const round_info& round_info);
-  void                         initialize                (const std::vector<particle>& particles,       std::vector<integral_curves>& integral_curves, const round_info& round_info);
-  void                         trace                     (const std::vector<particle>& particles,       std::vector<integral_curves>& integral_curves,       round_info& round_info);
+  void                         initialize                (const particle_array&        particles,       std::vector<integral_curves>& integral_curves, const round_info& round_info);
+  void                         trace                     (const particle_array&        particles,       std::vector<integral_curves>& integral_curves,       round_info& round_info);
   void                         load_balance_collect      (                                                                                                   round_info& round_info);
-  void                         out_of_bounds_distribute  (      std::vector<particle>& particles,                                                      const round_info& round_info);
-  bool                         check_completion          (const std::vector<particle>& particles                                                                                   );
+  void                         out_of_bounds_distribute  (      particle_array&        particles,                                                      const round_info& round_info);
+  bool                         check_completion          (const particle_array&        particles                                                                                   );
   void                         prune                     (                                              std::vector<integral_curves>& integral_curves                              );
 
+  // Sample cache hits and misses (in this order) accumulated by trace since the last reset.
+  std::array<std::size_t, 2>   sample_cache_statistics   () const;
+  void                         reset_sample_cache_statistics();
+
 protected:
-  partitioner*                                partitioner_            = nullptr;
+  void                         trace_packets             (const particle_array&        particles,       std::vector<integral_curves>& integral_curves,       round_info& round_info);
+  void                         require_neighbor_vector_field(std::size_t index);
+  bool                         within_neighbor_slab      (std::size_t index, const vector4& position) const;
+  std::vector<std::vector<std::size_t>> partition_by_node(const particle_array&        particles) const; // Particle indices per node of the numa scheduler.
+
+  partitioner*                                partitioner_                   = nullptr;
+  particle_transport                          transport_                     ;
 
-  std::optional<vector_field>*                local_vector_field_     = {};
-  std::array<std::optional<vector_field>, 6>* neighbor_vector_fields_ = {};
-  variant_integrator                          integrator_             = euler_integrator();
-  scalar                                      step_size_              = 1.0f;
+  std::optional<vector_field>*                local_vector_field_            = {};
+  std::array<std::optional<vector_field>, 6>* neighbor_vector_fields_        = {};
+  std::array<std::shared_future<void>, 6>     neighbor_vector_fields_loaded_ = {};
+  variant_integrator                          integrator_                    = euler_integrator();
+  scalar                                      step_size_                     = 1.0f;
+  bool                                        packet_mode_                   = false;
+  const unsteady_vector_field*                unsteady_vector_field_         = nullptr;
+  integer                                     neighbor_depth_                = 0;
+  block_cache*                                block_cache_                   = nullptr;
+  numa_scheduler*                             numa_scheduler_                = nullptr;
+  std::atomic<std::size_t>                    sample_cache_hits_             {0};
+  std::atomic<std::size_t>                    sample_cache_misses_           {0};
 };
 }
 
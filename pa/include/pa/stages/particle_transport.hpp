@@ -0,0 +1,66 @@
+#ifndef PA_STAGES_PARTICLE_TRANSPORT_HPP
+#define PA_STAGES_PARTICLE_TRANSPORT_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <boost/mpi.hpp>
+#include <mpi.h>
+
+#include <pa/math/particle_array.hpp>
+#include <pa/math/types.hpp>
+#include <pa/export.hpp>
+
+namespace pa
+{
+// Exchanges particle arrays as raw memory described by committed MPI datatypes, in place of boost::serialization.
+// The counts are exchanged first through persistent requests bound to the ranks of the last exchange (i.e. the neighbors),
+// then the particles are sent straight from the columns of the given arrays and received straight into the columns of the incoming array,
+// each message being described by a struct datatype over the absolute addresses of its column ranges (relative to MPI_BOTTOM).
+class PA_EXPORT particle_transport
+{
+public:
+  using entry = std::pair<integer, const particle_array*>;
+
+  explicit particle_transport  (boost::mpi::communicator* communicator);
+  particle_transport           (const particle_transport&  that) = delete ;
+  particle_transport           (      particle_transport&& temp) = delete ;
+  virtual ~particle_transport  ();
+  particle_transport& operator=(const particle_transport&  that) = delete ;
+  particle_transport& operator=(      particle_transport&& temp) = delete ;
+
+  // Sends the particles of each entry to its rank, and appends the particles each of these ranks sends in return to incoming, in the order of the entries.
+  // Returns the number of particles received from each entry. Each rank must list the other (e.g. both are neighbors).
+  std::vector<std::size_t> exchange  (const std::vector<entry>& outgoing, particle_array& incoming, int tag);
+  template <typename map_type> // Any range of (rank, particle_array) pairs, e.g. a particle_outbox.
+  std::vector<std::size_t> exchange  (const map_type&           outgoing, particle_array& incoming, int tag)
+  {
+    std::vector<entry> entries;
+    for (auto& neighbor : outgoing)
+      entries.emplace_back(neighbor.first, &neighbor.second);
+    return exchange(entries, incoming, tag);
+  }
+
+  // Sends outgoing[rank] to each rank, and appends the particles all ranks send in return to incoming, in rank order. Collective.
+  void                     all_to_all(const std::vector<particle_array>& outgoing, particle_array& incoming);
+
+protected:
+  // Describes the particles [begin, begin + count) of the array. The caller frees the datatype.
+  static MPI_Datatype      datatype  (const particle_array& particles, std::size_t begin, std::size_t count);
+
+  void                     bind      (const std::vector<integer>& ranks);
+  void                     unbind    ();
+
+  boost::mpi::communicator*       communicator_   = nullptr;
+
+  std::vector<integer>            ranks_          {};
+  std::vector<unsigned long long> send_counts_    {};
+  std::vector<unsigned long long> receive_counts_ {};
+  std::vector<MPI_Request>        count_requests_ {}; // Persistent receives, then persistent sends, one per rank.
+  std::vector<MPI_Request>        requests_       {};
+  std::vector<MPI_Datatype>       datatypes_      {}; // Of the messages in flight.
+};
+}
+
+#endif
\ No newline at end of file
@@ -16,12 +16,14 @@ class PA_EXPORT partitioner
 public:
   struct PA_EXPORT rank_info
   {
-    rank_info(integer rank, const ivector3& grid_size, const ivector3& block_size);
+    rank_info(integer rank, const ivector3& grid_size, const ivector3& block_size, integer ghost_width = 0);
 
     integer  rank               = 0 ;
     ivector3 multi_rank         = {};
     ivector3 offset             = {};
-    ivector3 ghosted_block_size = {};
+    ivector3 ghosted_block_size = {}; // Loaded region, including one voxel ghost region on the positive sides.
+    ivector3 lower_ghost_width  = {}; // Ghost layers exchanged with the neighbors on the negative sides.
+    ivector3 upper_ghost_width  = {}; // Ghost layers exchanged with the neighbors on the positive sides, beyond the loaded region.
   };
 
   explicit partitioner  (boost::mpi::communicator* communicator);
@@ -32,11 +34,13 @@ public:
   partitioner& operator=(      partitioner&& temp) = default;
 
   void                                           set_domain_size   (const ivector3& domain_size);
+  void                                           set_ghost_width   (integer         ghost_width); // Applies to subsequent set_domain_size calls.
 
   boost::mpi::communicator*                      communicator      ();
   const ivector3&                                domain_size       () const;
   const ivector3&                                grid_size         () const;
   const ivector3&                                block_size        () const;
+  integer                                        ghost_width       () const;
 
   const std::optional<rank_info>&                local_rank_info   () const;
   const std::array<std::optional<rank_info>, 6>& neighbor_rank_info() const;
@@ -47,6 +51,7 @@ protected:
   ivector3                                domain_size_        = {};
   ivector3                                grid_size_          = {};
   ivector3                                block_size_         = {};
+  integer                                 ghost_width_        = 0 ;
 
   std::optional<rank_info>                local_rank_info_    = {};
   std::array<std::optional<rank_info>, 6> neighbor_rank_info_ = {};
@@ -1,8 +1,9 @@
 #ifndef PA_STAGES_SEED_GENERATOR_HPP
 #define PA_STAGES_SEED_GENERATOR_HPP
 
-#include <pa/math/particle.hpp>
+#include <pa/math/particle_array.hpp>
 #include <pa/math/types.hpp>
+#include <pa/math/vector_field.hpp>
 #include <pa/export.hpp>
 
 namespace pa
@@ -10,7 +11,8 @@ namespace pa
 class PA_EXPORT seed_generator
 {
 public:
-  static std::vector<particle> generate(const vector3& offset, const vector3& size, const vector3& stride, integer remaining_iterations, integer rank);
+  // Seeds lying in empty macro cells of the vector field (if any) are discarded, since they would terminate at their first step.
+  static particle_array generate(const vector3& offset, const vector3& size, const vector3& stride, integer remaining_iterations, integer rank, const vector_field* vector_field = nullptr);
 };
 }
 
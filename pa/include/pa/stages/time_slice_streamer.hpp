@@ -0,0 +1,54 @@
+#ifndef PA_STAGES_TIME_SLICE_STREAMER_HPP
+#define PA_STAGES_TIME_SLICE_STREAMER_HPP
+
+#include <array>
+#include <cstddef>
+#include <future>
+#include <optional>
+
+#include <pa/math/types.hpp>
+#include <pa/math/unsteady_vector_field.hpp>
+#include <pa/math/vector_field.hpp>
+#include <pa/stages/data_io.hpp>
+#include <pa/export.hpp>
+
+namespace pa
+{
+// Streams the time slices of the local block of a time-varying vector field.
+// Keeps the two slices of the current interval resident while the next slice is loaded asynchronously, i.e. at most three slices per block.
+class PA_EXPORT time_slice_streamer
+{
+public:
+  explicit time_slice_streamer  (data_io* data_io);
+  time_slice_streamer           (const time_slice_streamer&  that) = delete ;
+  time_slice_streamer           (      time_slice_streamer&& temp) = delete ;
+  virtual ~time_slice_streamer  ()                                 = default;
+  time_slice_streamer& operator=(const time_slice_streamer&  that) = delete ;
+  time_slice_streamer& operator=(      time_slice_streamer&& temp) = delete ;
+
+  void                         set_prefetch    (bool prefetch);
+
+  bool                         load            (std::size_t time_slice = 0); // Loads the interval starting at the time slice. Returns false if there is no such interval.
+  bool                         advance         ();                           // Moves to the next interval. Returns false if the current interval is the last.
+  
+  std::size_t                  time_slice_count() const;
+  std::size_t                  time_slice      () const;                     // The first time slice of the current interval.
+  const unsteady_vector_field& interval        () const;
+
+protected:
+  void                         prefetch        ();
+  void                         update_interval ();
+
+  data_io*                                   data_io_          = nullptr;
+  bool                                       prefetch_         = true;
+  std::size_t                                time_slice_count_ = 0;
+  scalar                                     time_spacing_     = 1.0f;
+  std::size_t                                time_slice_       = 0;
+  std::size_t                                start_slot_       = 0;
+  std::array<std::optional<vector_field>, 3> slots_            {};
+  std::future<std::optional<vector_field>>   pending_          {};
+  unsteady_vector_field                      interval_         {};
+};
+}
+
+#endif
\ No newline at end of file
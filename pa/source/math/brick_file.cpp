@@ -0,0 +1,188 @@
+#include <pa/math/brick_file.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <boost/multi_array.hpp>
+#include <tbb/tbb.h>
+
+#include <pa/math/index.hpp>
+
+#undef min
+#undef max
+
+namespace pa
+{
+namespace
+{
+std::uint64_t align(const std::uint64_t offset)
+{
+  return (offset + brick_file::page_size - 1) / brick_file::page_size * brick_file::page_size;
+}
+}
+
+void                                 brick_file::create     (const HighFive::DataSet& dataset, const std::string& filepath, const std::array<std::size_t, 3>& origin, const std::array<std::size_t, 3>& shape, const std::uint64_t source_size, const std::uint64_t source_time)
+{
+  const auto dimensions = dataset.getDimensions();
+
+  file_header header;
+  header.source_size = source_size;
+  header.source_time = source_time;
+  header.components = dimensions.size() == 4 ? dimensions[3] : 1;
+  for (auto i = 0; i < 3; ++i)
+  {
+    header.shape       [i] = shape[i] != 0 ? shape[i] : dimensions[i] - origin[i];
+    header.brick_counts[i] = (header.shape[i] + brick_size - 1) / brick_size;
+  }
+  
+  const auto brick_count   = header.brick_counts[0] * header.brick_counts[1] * header.brick_counts[2];
+  const auto brick_volume  = brick_size * brick_size * brick_size * header.components;
+  header.metadata_offset   = page_size;
+  header.data_offset       = align(header.metadata_offset + brick_count * sizeof(brick_metadata));
+
+  // Reads the planes [begin, begin + count) in row-major order, components last.
+  std::vector<float> slab;
+  const auto read_slab = [&] (const std::size_t begin, const std::size_t count)
+  {
+    slab.resize(count * header.shape[1] * header.shape[2] * header.components);
+    if (dimensions.size() == 4)
+    {
+      boost::multi_array<float, 4> data;
+      dataset.select({origin[0] + begin, origin[1], origin[2], 0}, {count, header.shape[1], header.shape[2], header.components}, {1, 1, 1, 1}).read(data);
+      std::copy_n(data.data(), data.num_elements(), slab.begin());
+    }
+    else
+    {
+      boost::multi_array<float, 3> data;
+      dataset.select({origin[0] + begin, origin[1], origin[2]   }, {count, header.shape[1], header.shape[2]                   }, {1, 1, 1   }).read(data);
+      std::copy_n(data.data(), data.num_elements(), slab.begin());
+    }
+  };
+  const auto for_each_brick = [&] (const std::size_t brick_x, const auto& function)
+  {
+    tbb::parallel_for(tbb::blocked_range2d<std::size_t>(0, header.brick_counts[1], 0, header.brick_counts[2]), [&] (const tbb::blocked_range2d<std::size_t>& index) {
+      for (auto y = index.rows().begin(), y_end = index.rows().end(); y < y_end; ++y) {
+      for (auto z = index.cols().begin(), z_end = index.cols().end(); z < z_end; ++z) {
+        function((brick_x * header.brick_counts[1] + y) * header.brick_counts[2] + z, y, z);
+      }}
+    });
+  };
+  const auto for_each_element = [&] (const std::size_t brick_x, const std::size_t brick_y, const std::size_t brick_z, const auto& function)
+  {
+    for (std::size_t x = 0; x < brick_size && brick_x * brick_size + x < header.shape[0]; ++x)
+    for (std::size_t y = 0; y < brick_size && brick_y * brick_size + y < header.shape[1]; ++y)
+    for (std::size_t z = 0; z < brick_size && brick_z * brick_size + z < header.shape[2]; ++z)
+      function((x * brick_size + y) * brick_size + z, slab.data() + ((x * header.shape[1] + brick_y * brick_size + y) * header.shape[2] + brick_z * brick_size + z) * header.components);
+  };
+
+  // First pass: compute the metadata, then assign slots to the non-empty bricks along the Morton curve.
+  std::vector<brick_metadata> metadata(brick_count);
+  for (std::size_t brick_x = 0; brick_x < header.brick_counts[0]; ++brick_x)
+  {
+    read_slab(brick_x * brick_size, std::min<std::size_t>(brick_size, header.shape[0] - brick_x * brick_size));
+    for_each_brick(brick_x, [&] (const std::size_t index, const std::size_t brick_y, const std::size_t brick_z)
+    {
+      auto& entry   = metadata[index];
+      entry.minimum = std::numeric_limits<float>::max   ();
+      entry.maximum = std::numeric_limits<float>::lowest();
+      for_each_element(brick_x, brick_y, brick_z, [&] (const std::size_t, const float* element)
+      {
+        auto value = element[0];
+        if (header.components > 1)
+        {
+          value = 0;
+          for (std::size_t c = 0; c < header.components; ++c)
+            value += element[c] * element[c];
+          value = std::sqrt(value);
+        }
+        entry.minimum    = std::min(entry.minimum, value);
+        entry.maximum    = std::max(entry.maximum, value);
+        entry.occupancy += std::any_of(element, element + header.components, [ ] (const float component) { return component != 0.0f; });
+      });
+    });
+  }
+
+  std::vector<std::pair<std::uint64_t, std::size_t>> codes;
+  for (std::size_t x = 0; x < header.brick_counts[0]; ++x)
+  for (std::size_t y = 0; y < header.brick_counts[1]; ++y)
+  for (std::size_t z = 0; z < header.brick_counts[2]; ++z)
+  {
+    const auto index = (x * header.brick_counts[1] + y) * header.brick_counts[2] + z;
+    if (metadata[index].occupancy > 0)
+      codes.emplace_back(morton_encode(std::uint32_t(x), std::uint32_t(y), std::uint32_t(z)), index);
+  }
+  std::sort(codes.begin(), codes.end());
+  for (std::size_t slot = 1; slot <= codes.size(); ++slot)
+    metadata[codes[slot - 1].second].slot = std::uint32_t(slot);
+  header.stored_bricks = codes.size() + 1;
+
+  // Second pass: write the header, metadata, zero brick and the non-empty bricks at their slots.
+  std::ofstream stream(filepath, std::ios::binary | std::ios::trunc);
+  const auto write = [&] (const std::uint64_t offset, const void* data, const std::size_t size)
+  {
+    stream.seekp(offset);
+    stream.write(reinterpret_cast<const char*>(data), size);
+  };
+  write(0                     , &header        , sizeof header);
+  write(header.metadata_offset, metadata.data(), metadata.size() * sizeof(brick_metadata));
+
+  std::vector<float> zero_brick(brick_volume, 0.0f);
+  write(header.data_offset, zero_brick.data(), zero_brick.size() * sizeof(float));
+
+  std::vector<std::vector<float>> bricks(header.brick_counts[1] * header.brick_counts[2]);
+  for (std::size_t brick_x = 0; brick_x < header.brick_counts[0]; ++brick_x)
+  {
+    read_slab(brick_x * brick_size, std::min<std::size_t>(brick_size, header.shape[0] - brick_x * brick_size));
+    for_each_brick(brick_x, [&] (const std::size_t index, const std::size_t brick_y, const std::size_t brick_z)
+    {
+      auto& brick = bricks[brick_y * header.brick_counts[2] + brick_z];
+      brick.clear();
+      if (metadata[index].slot == 0)
+        return;
+      
+      brick.resize(brick_volume, 0.0f);
+      for_each_element(brick_x, brick_y, brick_z, [&] (const std::size_t offset, const float* element)
+      {
+        std::copy_n(element, header.components, brick.data() + offset * header.components);
+      });
+    });
+
+    for (std::size_t brick_y = 0; brick_y < header.brick_counts[1]; ++brick_y)
+      for (std::size_t brick_z = 0; brick_z < header.brick_counts[2]; ++brick_z)
+      {
+        const auto& brick = bricks[brick_y * header.brick_counts[2] + brick_z];
+        if (!brick.empty())
+          write(header.data_offset + metadata[(brick_x * header.brick_counts[1] + brick_y) * header.brick_counts[2] + brick_z].slot * brick_volume * sizeof(float), brick.data(), brick.size() * sizeof(float));
+      }
+  }
+  
+  if (!stream)
+    throw std::runtime_error("Unable to write brick file " + filepath + ".");
+}
+
+                                     brick_file::brick_file (const std::string& filepath) : file_(std::make_shared<boost::iostreams::mapped_file_source>(filepath))
+{
+  if (file_->size() < sizeof(file_header) || header().magic != magic || header().brick_size != brick_size)
+    throw std::runtime_error("Invalid brick file " + filepath + ".");
+  
+  const auto brick_count = header().brick_counts[0] * header().brick_counts[1] * header().brick_counts[2];
+  if (file_->size() < header().metadata_offset + brick_count * sizeof(brick_metadata) ||
+      file_->size() < header().data_offset     + header().stored_bricks * brick_size * brick_size * brick_size * header().components * sizeof(float))
+    throw std::runtime_error("Truncated brick file " + filepath + ".");
+}
+
+const brick_file::file_header&       brick_file::header     () const
+{
+  return *reinterpret_cast<const file_header*>(file_->data());
+}
+const brick_file::brick_metadata&    brick_file::metadata   (const std::size_t x, const std::size_t y, const std::size_t z) const
+{
+  const auto& info = header();
+  return reinterpret_cast<const brick_metadata*>(file_->data() + info.metadata_offset)[(x * info.brick_counts[1] + y) * info.brick_counts[2] + z];
+}
+}
\ No newline at end of file
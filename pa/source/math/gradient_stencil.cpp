@@ -0,0 +1,101 @@
+#include <pa/math/gradient_stencil.hpp>
+
+#include <algorithm>
+
+namespace pa
+{
+gradient_stencil::gradient_stencil(const pa::vector_field* vector_field) : field(vector_field), shape(vector_field->shape())
+{
+
+}
+
+void gradient_stencil::compute(const std::size_t x, const std::size_t y, const std::size_t z_begin, const std::size_t z_end)
+{
+  const auto count = z_end - z_begin;
+  for (auto& component : jacobian)
+    component.resize(count);
+
+  // Along x and y, a row differs from its neighbor rows as a whole.
+  for (std::size_t j = 0; j < 2; ++j)
+  {
+    const auto index        = j == 0 ? x : y;
+    const auto lower_index  = index > 0            ? index - 1 : index;
+    const auto upper_index  = index + 1 < shape[j] ? index + 1 : index;
+    if (lower_index == upper_index) // A single voxel along the axis.
+    {
+      for (std::size_t i = 0; i < 3; ++i)
+        std::fill(jacobian[3 * i + j].begin(), jacobian[3 * i + j].end(), scalar(0));
+      continue;
+    }
+
+    gather(j == 0 ? lower_index : x, j == 0 ? y : lower_index, z_begin, z_end, lower);
+    gather(j == 0 ? upper_index : x, j == 0 ? y : upper_index, z_begin, z_end, upper);
+
+    const auto factor = scalar(1) / (scalar(upper_index - lower_index) * field->spacing[j]);
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+      const auto lower_data  = lower   [i]        .data();
+      const auto upper_data  = upper   [i]        .data();
+      const auto target_data = jacobian[3 * i + j].data();
+      for (std::size_t k = 0; k < count; ++k)
+        target_data[k] = (upper_data[k] - lower_data[k]) * factor;
+    }
+  }
+
+  // Along z, a row differs from itself shifted by one voxel in either direction.
+  const auto padded_begin = z_begin > 0        ? z_begin - 1 : z_begin;
+  const auto padded_end   = z_end   < shape[2] ? z_end   + 1 : z_end  ;
+  if (padded_end - padded_begin < 2)
+  {
+    for (std::size_t i = 0; i < 3; ++i)
+      std::fill(jacobian[3 * i + 2].begin(), jacobian[3 * i + 2].end(), scalar(0));
+    return;
+  }
+  gather(x, y, padded_begin, padded_end, center);
+
+  const auto spacing = field->spacing[2];
+  const auto shift   = z_begin - padded_begin; // Position of z_begin within the center row.
+  const auto first   = z_begin == 0        ? std::size_t(1) : std::size_t(0); // Voxels at the bounds are left to the one-sided differences.
+  const auto last    = z_end   == shape[2] ? count - 1      : count;
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    const auto center_data = center  [i]        .data() + shift;
+    const auto target_data = jacobian[3 * i + 2].data();
+    const auto factor      = scalar(0.5) / spacing;
+    for (std::size_t k = first; k < last; ++k)
+      target_data[k] = (center_data[k + 1] - center_data[k - 1]) * factor;
+    if (first == 1)
+      target_data[0]         = (center_data[1]         - center_data[0]        ) / spacing;
+    if (last  == count - 1)
+      target_data[count - 1] = (center_data[count - 1] - center_data[count - 2]) / spacing;
+  }
+}
+
+void gradient_stencil::gather (const std::size_t x, const std::size_t y, const std::size_t z_begin, const std::size_t z_end, std::array<row, 3>& target) const
+{
+  const auto count = z_end - z_begin;
+  for (auto& component : target)
+    component.resize(count);
+
+  // The row-major layout is deinterleaved directly, the others are decoded voxel by voxel.
+  if (field->data_layout == vector_field::layout::linear)
+  {
+    const auto source = field->data[x][y].origin() + z_begin;
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+      const auto target_data = target[i].data();
+      for (std::size_t k = 0; k < count; ++k)
+        target_data[k] = source[k][i];
+    }
+    return;
+  }
+
+  for (std::size_t k = 0; k < count; ++k)
+  {
+    const auto value = field->at(x, y, z_begin + k);
+    target[0][k] = value[0];
+    target[1][k] = value[1];
+    target[2][k] = value[2];
+  }
+}
+}
\ No newline at end of file
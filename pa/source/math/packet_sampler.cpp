@@ -0,0 +1,74 @@
+#include <pa/math/packet_sampler.hpp>
+
+namespace pa
+{
+void           packet_sampler::set_vector_field(const std::size_t lane, const vector_field* vector_field)
+{
+  const auto shape  = vector_field->shape();
+  const auto origin = vector_field->origin();
+
+  vector_fields[lane] = vector_field;
+  caches       [lane] = vector_field::sample_cache();
+  for (auto i = 0; i < 3; ++i)
+  {
+    offsets     (lane, i) = origin               [i];
+    spacings    (lane, i) = vector_field->spacing[i];
+    upper_bounds(lane, i) = scalar(shape[i]) - scalar(1);
+  }
+}
+
+packet_mask    packet_sampler::contains        (const packet_vector3& positions) const
+{
+  const packet_vector3 subscripts = ((positions - offsets) / spacings).floor();
+  return ((subscripts >= scalar(0)) && (subscripts < upper_bounds)).rowwise().all();
+}
+packet_mask    packet_sampler::empty           (const packet_vector3& positions) const
+{
+  packet_mask empty = packet_mask::Constant(false);
+  for (std::size_t lane = 0; lane < packet_size; ++lane)
+    if (vector_fields[lane])
+      empty[lane] = vector_fields[lane]->empty(vector4(positions(lane, 0), positions(lane, 1), positions(lane, 2), scalar(0)));
+  return empty;
+}
+packet_vector3 packet_sampler::interpolate     (const packet_vector3& positions, const packet_mask& active)
+{
+  const packet_vector3 coordinates = (positions - offsets) / spacings;
+  const packet_vector3 subscripts  = coordinates.floor();
+  const packet_vector3 weights     = coordinates - subscripts;
+  const packet_integer multi_index = subscripts.cast<integer>();
+
+  // Gather the corners lane by lane (unless the lane is still in its cached cell), then interpolate all lanes at once.
+  std::array<packet_vector3, 8> corners;
+  corners.fill(packet_vector3::Zero());
+  for (std::size_t lane = 0; lane < packet_size; ++lane)
+  {
+    if (!active[lane])
+      continue;
+
+    auto& cache = caches[lane];
+    if (multi_index.row(lane).transpose().matrix() != cache.multi_index)
+    {
+      vector_fields[lane]->gather(multi_index.row(lane).transpose(), cache.corners);
+      cache.multi_index = multi_index.row(lane).transpose();
+      ++cache.misses;
+    }
+    else
+      ++cache.hits;
+
+    for (auto i = 0; i < 8; ++i)
+      corners[i].row(lane) = cache.corners[i].transpose().array();
+  }
+
+  const auto lerp = [ ] (const packet_vector3& x, const packet_vector3& y, const packet_scalar& weight) -> packet_vector3
+  {
+    return x.colwise() * (scalar(1) - weight) + y.colwise() * weight;
+  };
+  const packet_vector3 c00 = lerp(corners[0], corners[1], weights.col(2));
+  const packet_vector3 c01 = lerp(corners[2], corners[3], weights.col(2));
+  const packet_vector3 c10 = lerp(corners[4], corners[5], weights.col(2));
+  const packet_vector3 c11 = lerp(corners[6], corners[7], weights.col(2));
+  const packet_vector3 c0  = lerp(c00       , c01       , weights.col(1));
+  const packet_vector3 c1  = lerp(c10       , c11       , weights.col(1));
+  return                     lerp(c0        , c1        , weights.col(0));
+}
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include <pa/math/particle_array.hpp>
+
+namespace pa
+{
+std::size_t particle_array::size        () const
+{
+  return x.size();
+}
+bool        particle_array::empty       () const
+{
+  return x.empty();
+}
+void        particle_array::resize      (const std::size_t size)
+{
+  x                   .resize(size);
+  y                   .resize(size);
+  z                   .resize(size);
+  t                   .resize(size);
+  remaining_iterations.resize(size);
+  vector_field_index  .resize(size);
+  original_rank       .resize(size);
+  original_voxel      .resize(size, ivector3::Zero());
+}
+void        particle_array::reserve     (const std::size_t size)
+{
+  x                   .reserve(size);
+  y                   .reserve(size);
+  z                   .reserve(size);
+  t                   .reserve(size);
+  remaining_iterations.reserve(size);
+  vector_field_index  .reserve(size);
+  original_rank       .reserve(size);
+  original_voxel      .reserve(size);
+}
+void        particle_array::clear       ()
+{
+  resize(0);
+}
+
+particle    particle_array::get         (const std::size_t index) const
+{
+  return particle {position(index), remaining_iterations[index], vector_field_index[index], original_rank[index], original_voxel[index]};
+}
+void        particle_array::set         (const std::size_t index, const particle& particle)
+{
+  set_position(index, particle.position);
+  remaining_iterations[index] = particle.remaining_iterations;
+  vector_field_index  [index] = particle.vector_field_index  ;
+  original_rank       [index] = particle.original_rank       ;
+  original_voxel      [index] = particle.original_voxel      ;
+}
+void        particle_array::push_back   (const particle& particle)
+{
+  x                   .push_back(particle.position[0]);
+  y                   .push_back(particle.position[1]);
+  z                   .push_back(particle.position[2]);
+  t                   .push_back(particle.position[3]);
+  remaining_iterations.push_back(particle.remaining_iterations);
+  vector_field_index  .push_back(particle.vector_field_index  );
+  original_rank       .push_back(particle.original_rank       );
+  original_voxel      .push_back(particle.original_voxel      );
+}
+void        particle_array::append      (const particle_array& that, const std::size_t begin, const std::size_t end)
+{
+  x                   .insert(x                   .end(), that.x                   .begin() + begin, that.x                   .begin() + end);
+  y                   .insert(y                   .end(), that.y                   .begin() + begin, that.y                   .begin() + end);
+  z                   .insert(z                   .end(), that.z                   .begin() + begin, that.z                   .begin() + end);
+  t                   .insert(t                   .end(), that.t                   .begin() + begin, that.t                   .begin() + end);
+  remaining_iterations.insert(remaining_iterations.end(), that.remaining_iterations.begin() + begin, that.remaining_iterations.begin() + end);
+  vector_field_index  .insert(vector_field_index  .end(), that.vector_field_index  .begin() + begin, that.vector_field_index  .begin() + end);
+  original_rank       .insert(original_rank       .end(), that.original_rank       .begin() + begin, that.original_rank       .begin() + end);
+  original_voxel      .insert(original_voxel      .end(), that.original_voxel      .begin() + begin, that.original_voxel      .begin() + end);
+}
+void        particle_array::append      (const particle_array& that)
+{
+  append(that, 0, that.size());
+}
+void        particle_array::swap        (const std::size_t lhs, const std::size_t rhs)
+{
+  std::swap(x                   [lhs], x                   [rhs]);
+  std::swap(y                   [lhs], y                   [rhs]);
+  std::swap(z                   [lhs], z                   [rhs]);
+  std::swap(t                   [lhs], t                   [rhs]);
+  std::swap(remaining_iterations[lhs], remaining_iterations[rhs]);
+  std::swap(vector_field_index  [lhs], vector_field_index  [rhs]);
+  std::swap(original_rank       [lhs], original_rank       [rhs]);
+  std::swap(original_voxel      [lhs], original_voxel      [rhs]);
+}
+
+vector4     particle_array::position    (const std::size_t index) const
+{
+  return vector4(x[index], y[index], z[index], t[index]);
+}
+void        particle_array::set_position(const std::size_t index, const vector4& position)
+{
+  x[index] = position[0];
+  y[index] = position[1];
+  z[index] = position[2];
+  t[index] = position[3];
+}
+}
\ No newline at end of file
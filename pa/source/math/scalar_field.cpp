@@ -0,0 +1,25 @@
+#include <pa/math/scalar_field.hpp>
+
+namespace pa
+{
+std::array<std::size_t, 3> scalar_field::shape() const
+{
+  switch (data_layout)
+  {
+  case layout::linear   : return {data   .shape()[0], data   .shape()[1], data   .shape()[2]};
+  case layout::linear_8 : return {data_8 .shape()[0], data_8 .shape()[1], data_8 .shape()[2]};
+  case layout::linear_16: return {data_16.shape()[0], data_16.shape()[1], data_16.shape()[2]};
+  default               : return sparse_data.shape();
+  }
+}
+scalar                     scalar_field::at   (const std::size_t x, const std::size_t y, const std::size_t z) const
+{
+  switch (data_layout)
+  {
+  case layout::linear   : return        data   [x][y][z] ;
+  case layout::linear_8 : return scalar(data_8 [x][y][z]);
+  case layout::linear_16: return scalar(data_16[x][y][z]);
+  default               : return sparse_data(x, y, z);
+  }
+}
+}
\ No newline at end of file
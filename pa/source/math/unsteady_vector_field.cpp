@@ -0,0 +1,31 @@
+#include <pa/math/unsteady_vector_field.hpp>
+
+#include <algorithm>
+
+#include <pa/math/linear_interpolate.hpp>
+
+namespace pa
+{
+bool    unsteady_vector_field::contains   (const vector4& position) const
+{
+  return start->contains(position);
+}
+bool    unsteady_vector_field::expired    (const vector4& position) const
+{
+  return position[3] >= end_time;
+}
+bool    unsteady_vector_field::empty      (const vector4& position) const
+{
+  return start->empty(position) && end->empty(position);
+}
+vector3 unsteady_vector_field::interpolate(const vector4& position) const
+{
+  sample_cache cache;
+  return interpolate(position, cache);
+}
+vector3 unsteady_vector_field::interpolate(const vector4& position, sample_cache& cache) const
+{
+  const auto weight = std::clamp((position[3] - start_time) / (end_time - start_time), scalar(0), scalar(1));
+  return linear_interpolate(start->interpolate(position, cache[0]), end->interpolate(position, cache[1]), weight);
+}
+}
\ No newline at end of file
@@ -1,94 +1,242 @@
 #include <pa/math/vector_field.hpp>
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 
 #include <tbb/tbb.h>
 
+#include <pa/math/gradient_stencil.hpp>
 #include <pa/math/linear_interpolate.hpp>
 
 namespace pa
 {
+namespace
+{
+template <typename type, typename decoder_type>
+void gather_bricked(const bricked_array<type>& array, const ivector3& multi_index, std::array<vector3, 8>& corners, const decoder_type& decode)
+{
+  using bricks = bricked_array<type>;
+
+  const auto x = std::size_t(multi_index[0]), y = std::size_t(multi_index[1]), z = std::size_t(multi_index[2]);
+  if (array.interior(x, y, z)) // All corners lie in the same brick: a single table lookup.
+  {
+    const auto c000 = array.data() + array.index(x, y, z);
+    corners[0] = decode(c000[0]);
+    corners[1] = decode(c000[                                      bricks::stride_z]);
+    corners[2] = decode(c000[                   bricks::stride_y                   ]);
+    corners[3] = decode(c000[                   bricks::stride_y + bricks::stride_z]);
+    corners[4] = decode(c000[bricks::stride_x                                      ]);
+    corners[5] = decode(c000[bricks::stride_x                    + bricks::stride_z]);
+    corners[6] = decode(c000[bricks::stride_x + bricks::stride_y                   ]);
+    corners[7] = decode(c000[bricks::stride_x + bricks::stride_y + bricks::stride_z]);
+  }
+  else
+  {
+    corners[0] = decode(array(x    , y    , z    ));
+    corners[1] = decode(array(x    , y    , z + 1));
+    corners[2] = decode(array(x    , y + 1, z    ));
+    corners[3] = decode(array(x    , y + 1, z + 1));
+    corners[4] = decode(array(x + 1, y    , z    ));
+    corners[5] = decode(array(x + 1, y    , z + 1));
+    corners[6] = decode(array(x + 1, y + 1, z    ));
+    corners[7] = decode(array(x + 1, y + 1, z + 1));
+  }
+}
+template <typename type>
+void gather_strided(const strided_array<type>& array, const ivector3& multi_index, std::array<vector3, 8>& corners)
+{
+  const auto x = std::size_t(multi_index[0]), y = std::size_t(multi_index[1]), z = std::size_t(multi_index[2]);
+  corners[0] = array(x    , y    , z    ).template cast<scalar>();
+  corners[1] = array(x    , y    , z + 1).template cast<scalar>();
+  corners[2] = array(x    , y + 1, z    ).template cast<scalar>();
+  corners[3] = array(x    , y + 1, z + 1).template cast<scalar>();
+  corners[4] = array(x + 1, y    , z    ).template cast<scalar>();
+  corners[5] = array(x + 1, y    , z + 1).template cast<scalar>();
+  corners[6] = array(x + 1, y + 1, z    ).template cast<scalar>();
+  corners[7] = array(x + 1, y + 1, z + 1).template cast<scalar>();
+}
+}
+
 bool                          vector_field::contains   (const vector4& position) const
 {
+  const auto dimensions = shape();
+  const auto origin     = this->origin();
   for (auto i = 0; i < 3; ++i)
   {
-    const auto subscript = std::floor((position[i] - offset[i]) / spacing[i]);
-    if (0 > std::size_t(subscript) || std::size_t(subscript) >= data.shape()[i] - 1)
+    const auto subscript = std::floor((position[i] - origin[i]) / spacing[i]);
+    if (0 > std::size_t(subscript) || std::size_t(subscript) >= dimensions[i] - 1)
       return false;
   }
   return true;
 }
 vector3                       vector_field::interpolate(const vector4& position) const
 {
+  sample_cache cache;
+  return interpolate(position, cache);
+}
+vector3                       vector_field::interpolate(const vector4& position, sample_cache& cache) const
+{
+  const auto origin = this->origin();
+
   ivector3 multi_index;
   vector3  weights    ;
   for (auto i = 0; i < 3; ++i)
   {
-    multi_index[i] = std::floor((position[i] - offset[i]) / spacing[i]);
-    weights    [i] = std::fmod ((position[i] - offset[i]) , spacing[i]) / spacing[i];
+    multi_index[i] = std::floor((position[i] - origin[i]) / spacing[i]);
+    weights    [i] = std::fmod ((position[i] - origin[i]) , spacing[i]) / spacing[i];
   }
 
-  const auto& c000 = data(std::array<integer, 3>{multi_index[0]    , multi_index[1]    , multi_index[2]    });
-  const auto& c001 = data(std::array<integer, 3>{multi_index[0]    , multi_index[1]    , multi_index[2] + 1});
-  const auto& c010 = data(std::array<integer, 3>{multi_index[0]    , multi_index[1] + 1, multi_index[2]    });
-  const auto& c011 = data(std::array<integer, 3>{multi_index[0]    , multi_index[1] + 1, multi_index[2] + 1});
-  const auto& c100 = data(std::array<integer, 3>{multi_index[0] + 1, multi_index[1]    , multi_index[2]    });
-  const auto& c101 = data(std::array<integer, 3>{multi_index[0] + 1, multi_index[1]    , multi_index[2] + 1});
-  const auto& c110 = data(std::array<integer, 3>{multi_index[0] + 1, multi_index[1] + 1, multi_index[2]    });
-  const auto& c111 = data(std::array<integer, 3>{multi_index[0] + 1, multi_index[1] + 1, multi_index[2] + 1});
+  if (multi_index != cache.multi_index)
+  {
+    gather(multi_index, cache.corners);
+    cache.multi_index = multi_index;
+    ++cache.misses;
+  }
+  else
+    ++cache.hits;
 
-  const auto  c00  = linear_interpolate(c000, c001, weights[2]);
-  const auto  c01  = linear_interpolate(c010, c011, weights[2]);
-  const auto  c10  = linear_interpolate(c100, c101, weights[2]);
-  const auto  c11  = linear_interpolate(c110, c111, weights[2]);
+  const auto& corners = cache.corners;
+  const auto  c00  = linear_interpolate(corners[0], corners[1], weights[2]);
+  const auto  c01  = linear_interpolate(corners[2], corners[3], weights[2]);
+  const auto  c10  = linear_interpolate(corners[4], corners[5], weights[2]);
+  const auto  c11  = linear_interpolate(corners[6], corners[7], weights[2]);
   const auto  c0   = linear_interpolate(c00 , c01 , weights[1]);
   const auto  c1   = linear_interpolate(c10 , c11 , weights[1]);
   return             linear_interpolate(c0  , c1  , weights[0]);
 }
+void                          vector_field::gather     (const ivector3& multi_index, std::array<vector3, 8>& corners) const
+{
+  switch (data_layout)
+  {
+  case layout::mapped            :
+  case layout::sparse            :
+  case layout::bricked           : gather_bricked(bricked_data   , multi_index, corners, [ ] (const vector3&            value) { return value; }); break;
+  case layout::bricked_half      : gather_bricked(half_data      , multi_index, corners, [ ] (const half_vector3&       value) { return value.decode(); }); break;
+  case layout::bricked_octahedral: gather_bricked(octahedral_data, multi_index, corners, [&] (const octahedral_vector3& value) { return value.decode(magnitude_scale); }); break;
+  case layout::external          : gather_strided(external_data  , multi_index, corners); break;
+  case layout::external_double   : gather_strided(double_data    , multi_index, corners); break;
+  default:
+    corners[0] = data(std::array<integer, 3>{multi_index[0]    , multi_index[1]    , multi_index[2]    });
+    corners[1] = data(std::array<integer, 3>{multi_index[0]    , multi_index[1]    , multi_index[2] + 1});
+    corners[2] = data(std::array<integer, 3>{multi_index[0]    , multi_index[1] + 1, multi_index[2]    });
+    corners[3] = data(std::array<integer, 3>{multi_index[0]    , multi_index[1] + 1, multi_index[2] + 1});
+    corners[4] = data(std::array<integer, 3>{multi_index[0] + 1, multi_index[1]    , multi_index[2]    });
+    corners[5] = data(std::array<integer, 3>{multi_index[0] + 1, multi_index[1]    , multi_index[2] + 1});
+    corners[6] = data(std::array<integer, 3>{multi_index[0] + 1, multi_index[1] + 1, multi_index[2]    });
+    corners[7] = data(std::array<integer, 3>{multi_index[0] + 1, multi_index[1] + 1, multi_index[2] + 1});
+  }
+}
+void                          vector_field::compute_macro_grid(const std::size_t cell_size)
+{
+  const auto dimensions = shape();
+
+  std::array<std::size_t, 3> macro_dimensions;
+  for (auto i = 0; i < 3; ++i)
+    macro_dimensions[i] = dimensions[i] > 1 ? (dimensions[i] - 2) / cell_size + 1 : 0; // Ceiled cell count (shape - 1) / cell size.
+
+  macro_cell_size = cell_size;
+  macro_grid.resize(macro_dimensions);
+  tbb::parallel_for(tbb::blocked_range3d<std::size_t>(0, macro_dimensions[0], 0, macro_dimensions[1], 0, macro_dimensions[2]), [&] (const tbb::blocked_range3d<std::size_t>& index) {
+    for (auto x = index.pages().begin(), x_end = index.pages().end(); x < x_end; ++x) {
+    for (auto y = index.rows ().begin(), y_end = index.rows ().end(); y < y_end; ++y) {
+    for (auto z = index.cols ().begin(), z_end = index.cols ().end(); z < z_end; ++z) {
+      // The voxel range is inclusive, since the last cell of a macro cell reads the first voxels of the next.
+      scalar maximum = 0;
+      for (auto vx = x * cell_size, vx_end = std::min((x + 1) * cell_size, dimensions[0] - 1); vx <= vx_end; ++vx)
+      for (auto vy = y * cell_size, vy_end = std::min((y + 1) * cell_size, dimensions[1] - 1); vy <= vy_end; ++vy)
+      for (auto vz = z * cell_size, vz_end = std::min((z + 1) * cell_size, dimensions[2] - 1); vz <= vz_end; ++vz)
+        maximum = std::max(maximum, at(vx, vy, vz).norm());
+      macro_grid[x][y][z] = maximum;
+    }}}
+  });
+}
+bool                          vector_field::empty             (const vector4& position) const
+{
+  if (macro_grid.num_elements() == 0)
+    return false;
+
+  const auto origin = this->origin();
+
+  std::array<std::size_t, 3> macro_index;
+  for (auto i = 0; i < 3; ++i)
+  {
+    const auto subscript = std::floor((position[i] - origin[i]) / spacing[i]);
+    if (subscript < scalar(0))
+      return false;
+    macro_index[i] = std::size_t(subscript) / macro_cell_size;
+    if (macro_index[i] >= macro_grid.shape()[i])
+      return false;
+  }
+  return macro_grid(macro_index) == scalar(0);
+}
 std::unique_ptr<tensor_field> vector_field::gradient   ()
 {
+  const auto dimensions = shape();
   auto tensor_field = std::make_unique<pa::tensor_field>();
   tensor_field->data.resize(boost::extents
-   [data.shape()[0]]
-   [data.shape()[1]]
-   [data.shape()[2]]);
+   [dimensions[0]]
+   [dimensions[1]]
+   [dimensions[2]]);
   tensor_field->offset  = offset ;
   tensor_field->size    = size   ;
   tensor_field->spacing = spacing;
 
-  tbb::parallel_for(tbb::blocked_range3d<std::size_t>(0, data.shape()[0], 0, data.shape()[1], 0, data.shape()[2]), [&] (const tbb::blocked_range3d<std::size_t>& index) {
-    for (auto x = index.pages().begin(), x_end = index.pages().end(); x < x_end; ++x) {
-    for (auto y = index.rows ().begin(), y_end = index.rows ().end(); y < y_end; ++y) {
-    for (auto z = index.cols ().begin(), z_end = index.cols ().end(); z < z_end; ++z) {
-      auto& gradient          = tensor_field->data[x][y][z];
-
-      vector3 initial_xp1_y_z = vector3(x + 1, y    , z    ).array() * tensor_field->spacing.array();
-      vector3 initial_xm1_y_z = vector3(x - 1, y    , z    ).array() * tensor_field->spacing.array();
-      vector3 initial_x_yp1_z = vector3(x    , y + 1, z    ).array() * tensor_field->spacing.array();
-      vector3 initial_x_ym1_z = vector3(x    , y - 1, z    ).array() * tensor_field->spacing.array();
-      vector3 initial_x_y_zp1 = vector3(x    , y    , z - 1).array() * tensor_field->spacing.array();
-      vector3 initial_x_y_zm1 = vector3(x    , y    , z + 1).array() * tensor_field->spacing.array();
-              
-      vector3 final_xp1_y_z   = x + 1 < data.shape()[0] ? data[x + 1][y    ][z    ] : vector3(0, 0, 0);
-      vector3 final_xm1_y_z   = x     > 0               ? data[x - 1][y    ][z    ] : vector3(0, 0, 0);
-      vector3 final_x_yp1_z   = y + 1 < data.shape()[1] ? data[x    ][y + 1][z    ] : vector3(0, 0, 0);
-      vector3 final_x_ym1_z   = y     > 0               ? data[x    ][y - 1][z    ] : vector3(0, 0, 0);
-      vector3 final_x_y_zp1   = z + 1 < data.shape()[2] ? data[x    ][y    ][z + 1] : vector3(0, 0, 0);
-      vector3 final_x_y_zm1   = z     > 0               ? data[x    ][y    ][z - 1] : vector3(0, 0, 0);
-
-      gradient(0, 0)          = (final_xp1_y_z[0] - final_xm1_y_z[0]) / (initial_xp1_y_z[0] - initial_xm1_y_z[0]);
-      gradient(0, 1)          = (final_x_yp1_z[0] - final_x_ym1_z[0]) / (initial_x_yp1_z[1] - initial_x_ym1_z[1]);
-      gradient(0, 2)          = (final_x_y_zp1[0] - final_x_y_zm1[0]) / (initial_x_y_zp1[2] - initial_x_y_zm1[2]);
-      gradient(1, 0)          = (final_xp1_y_z[1] - final_xm1_y_z[1]) / (initial_xp1_y_z[0] - initial_xm1_y_z[0]);
-      gradient(1, 1)          = (final_x_yp1_z[1] - final_x_ym1_z[1]) / (initial_x_yp1_z[1] - initial_x_ym1_z[1]);
-      gradient(1, 2)          = (final_x_y_zp1[1] - final_x_y_zm1[1]) / (initial_x_y_zp1[2] - initial_x_y_zm1[2]);
-      gradient(3, 0)          = (final_xp1_y_z[2] - final_xm1_y_z[2]) / (initial_xp1_y_z[0] - initial_xm1_y_z[0]);
-      gradient(3, 1)          = (final_x_yp1_z[2] - final_x_ym1_z[2]) / (initial_x_yp1_z[1] - initial_x_ym1_z[1]);
-      gradient(3, 2)          = (final_x_y_zp1[2] - final_x_y_zm1[2]) / (initial_x_y_zp1[2] - initial_x_y_zm1[2]);
-    }}}
+  tbb::parallel_for(tbb::blocked_range2d<std::size_t>(0, dimensions[0], 0, dimensions[1]), [&] (const tbb::blocked_range2d<std::size_t>& index) {
+    gradient_stencil stencil(this);
+    for (auto x = index.rows().begin(), x_end = index.rows().end(); x < x_end; ++x) {
+    for (auto y = index.cols().begin(), y_end = index.cols().end(); y < y_end; ++y) {
+      stencil.compute(x, y, 0, dimensions[2]);
+      for (std::size_t z = 0; z < dimensions[2]; ++z)
+      {
+        auto& gradient = tensor_field->data[x][y][z];
+        for (std::size_t i = 0; i < 3; ++i)
+        for (std::size_t j = 0; j < 3; ++j)
+          gradient(i, j) = stencil.jacobian[3 * i + j][z];
+      }
+    }}
   });
 
   return tensor_field;
 }
+std::array<std::size_t, 3>    vector_field::shape      () const
+{
+  switch (data_layout)
+  {
+  case layout::mapped            :
+  case layout::sparse            :
+  case layout::bricked           : return bricked_data   .shape();
+  case layout::bricked_half      : return half_data      .shape();
+  case layout::bricked_octahedral: return octahedral_data.shape();
+  case layout::external          : return external_data  .shape();
+  case layout::external_double   : return double_data    .shape();
+  default                        : return {data.shape()[0], data.shape()[1], data.shape()[2]};
+  }
+}
+vector3                       vector_field::at         (const std::size_t x, const std::size_t y, const std::size_t z) const
+{
+  switch (data_layout)
+  {
+  case layout::mapped            :
+  case layout::sparse            :
+  case layout::bricked           : return bricked_data   (x, y, z);
+  case layout::bricked_half      : return half_data      (x, y, z).decode();
+  case layout::bricked_octahedral: return octahedral_data(x, y, z).decode(magnitude_scale);
+  case layout::external          : return external_data  (x, y, z);
+  case layout::external_double   : return double_data    (x, y, z).cast<scalar>();
+  default                        : return data[x][y][z];
+  }
+}
+vector3                       vector_field::origin     () const
+{
+  return offset.array() - lower_ghost_width.cast<scalar>().array() * spacing.array();
+}
+std::size_t                   vector_field::byte_size  () const
+{
+  return data           .num_elements() * sizeof(vector3           ) +
+         bricked_data   .num_elements() * sizeof(vector3           ) +
+         half_data      .num_elements() * sizeof(half_vector3      ) +
+         octahedral_data.num_elements() * sizeof(octahedral_vector3) +
+         macro_grid     .num_elements() * sizeof(scalar            );
 }
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include <pa/stages/block_cache.hpp>
+
+#include <iterator>
+
+namespace pa
+{
+block_cache::block_cache(data_io* data_io) : data_io_(data_io)
+{
+
+}
+
+void                                        block_cache::set_memory_budget (const std::size_t memory_budget )
+{
+  memory_budget_  = memory_budget ;
+}
+void                                        block_cache::set_neighbor_depth(const integer     neighbor_depth)
+{
+  neighbor_depth_ = neighbor_depth;
+}
+
+const vector_field&                         block_cache::acquire           (const std::size_t index)
+{
+  recently_used_.remove    (index);
+  recently_used_.push_front(index);
+  pinned_[index] = true;
+
+  if (!vector_fields_[index])
+  {
+    vector_fields_[index] = data_io_->load_neighbor_vector_field(index, neighbor_depth_);
+    loads_++;
+    evict();
+  }
+  return vector_fields_[index].value();
+}
+void                                        block_cache::release           ()
+{
+  pinned_.fill(false);
+  evict();
+}
+void                                        block_cache::clear             ()
+{
+  for (auto& vector_field : vector_fields_)
+    vector_field.reset();
+  pinned_       .fill(false);
+  recently_used_.clear();
+  loads_     = 0;
+  evictions_ = 0;
+}
+
+std::array<std::optional<vector_field>, 6>* block_cache::vector_fields     ()
+{
+  return &vector_fields_;
+}
+std::size_t                                 block_cache::memory_usage      () const
+{
+  std::size_t memory_usage = 0;
+  for (auto& vector_field : vector_fields_)
+    if (vector_field)
+      memory_usage += vector_field->byte_size();
+  return memory_usage;
+}
+std::array<std::size_t, 2>                  block_cache::statistics        () const
+{
+  return {loads_, evictions_};
+}
+
+void                                        block_cache::evict             ()
+{
+  if (memory_budget_ == 0)
+    return;
+
+  for (auto iterator = recently_used_.rbegin(); iterator != recently_used_.rend() && memory_usage() > memory_budget_;)
+  {
+    const auto index = *iterator;
+    if (pinned_[index])
+    {
+      ++iterator;
+      continue;
+    }
+
+    vector_fields_[index].reset();
+    evictions_++;
+    iterator = std::make_reverse_iterator(recently_used_.erase(std::next(iterator).base()));
+  }
+}
+}
\ No newline at end of file
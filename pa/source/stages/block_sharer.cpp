@@ -0,0 +1,151 @@
+#include <pa/stages/block_sharer.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace pa
+{
+namespace
+{
+// Each segment begins with the shape and magnitude scale of its vector field, followed by its bricks.
+struct segment_header
+{
+  std::array<std::uint64_t, 3> shape;
+  scalar                       magnitude_scale;
+};
+constexpr std::size_t data_offset = 64;
+
+template <typename function_type>
+void for_bricked_data(vector_field& vector_field, const function_type& function)
+{
+  switch (vector_field.data_layout)
+  {
+  case vector_field::layout::bricked           : function(vector_field.bricked_data   ); break;
+  case vector_field::layout::bricked_half      : function(vector_field.half_data      ); break;
+  case vector_field::layout::bricked_octahedral: function(vector_field.octahedral_data); break;
+  default: throw std::runtime_error("Block sharing requires a dense bricked vector field layout.");
+  }
+}
+
+// Views the bricks at the data offset of the segment without copying. The window outlives the view.
+template <typename type>
+void map_segment(bricked_array<type>& array, const char* segment)
+{
+  const auto& header  = *reinterpret_cast<const segment_header*>(segment);
+  const typename bricked_array<type>::shape_type shape {header.shape[0], header.shape[1], header.shape[2]};
+  array.map(shape, {0, 0, 0}, bricked_array<type>::morton_table(shape), std::shared_ptr<const type>(std::shared_ptr<const type>(), reinterpret_cast<const type*>(segment + data_offset)));
+}
+}
+
+block_sharer::block_sharer (partitioner* partitioner, data_io* data_io) : partitioner_(partitioner), data_io_(data_io)
+{
+  MPI_Comm communicator;
+  MPI_Comm_split_type(MPI_Comm(*partitioner_->communicator()), MPI_COMM_TYPE_SHARED, partitioner_->communicator()->rank(), MPI_INFO_NULL, &communicator);
+  node_communicator_ = boost::mpi::communicator(communicator, boost::mpi::comm_take_ownership);
+}
+block_sharer::~block_sharer()
+{
+  // The vector fields of the last load may already be destroyed, hence are not reset.
+  if (window_ != MPI_WIN_NULL)
+    MPI_Win_free(&window_);
+}
+
+void                      block_sharer::load             (std::optional<vector_field>* local_vector_field, std::array<std::optional<vector_field>, 6>* neighbor_vector_fields, const integer depth)
+{
+  release();
+
+  if (partitioner_->ghost_width() != 0)
+    throw std::runtime_error("Block sharing requires a ghost width of zero.");
+
+  local_vector_field_     = local_vector_field    ;
+  neighbor_vector_fields_ = neighbor_vector_fields;
+  shared_neighbors_       = 0;
+
+  // Sizes the segment of this rank from the ghosted block size, and loads the local block straight into it.
+  const auto& ghosted = partitioner_->local_rank_info()->ghosted_block_size;
+  const std::array<std::size_t, 3> shape {std::size_t(ghosted[0]), std::size_t(ghosted[1]), std::size_t(ghosted[2])};
+
+  vector_field layout;
+  layout.data_layout = data_io_->vector_field_layout();
+  std::size_t size = data_offset;
+  for_bricked_data(layout, [&] (auto& array) { size += array.storage_size(shape) * sizeof(*array.data()); });
+
+  MPI_Info info;
+  MPI_Info_create(&info);
+  MPI_Info_set   (info, "alloc_shared_noncontig", "true"); // Lets each segment be placed on the memory of its own socket.
+  char* segment = nullptr;
+  MPI_Win_allocate_shared(MPI_Aint(size), 1, info, MPI_Comm(node_communicator_), &segment, &window_);
+  MPI_Info_free  (&info);
+
+  auto& local  = local_vector_field->emplace(data_io_->load_local_vector_field_into(segment + data_offset).value());
+  auto& header = *reinterpret_cast<segment_header*>(segment);
+  header.magnitude_scale = local.magnitude_scale;
+  for (auto i = 0; i < 3; ++i)
+    header.shape[i] = shape[i];
+  for_bricked_data(local, [&] (auto& array) { map_segment(array, segment); }); // Read-only from here on.
+  
+  // Completes the loads of all ranks on the node before any segment is viewed.
+  MPI_Win_fence(0, window_);
+
+  if (!neighbor_vector_fields)
+    return;
+
+  std::vector<int> ranks;
+  boost::mpi::all_gather(node_communicator_, partitioner_->communicator()->rank(), ranks);
+
+  auto& neighbors = partitioner_->neighbor_rank_info();
+  for (std::size_t i = 0; i < neighbors.size(); ++i)
+  {
+    auto& neighbor_vector_field = (*neighbor_vector_fields)[i];
+    neighbor_vector_field.reset();
+    if (!neighbors[i])
+      continue;
+
+    const auto iterator = std::find(ranks.begin(), ranks.end(), neighbors[i]->rank);
+    if (iterator == ranks.end())
+    {
+      neighbor_vector_field = data_io_->load_neighbor_vector_field(i, depth);
+      continue;
+    }
+
+    MPI_Aint peer_size;
+    int      peer_displacement_unit;
+    char*    peer_segment = nullptr;
+    MPI_Win_shared_query(window_, int(std::distance(ranks.begin(), iterator)), &peer_size, &peer_displacement_unit, &peer_segment);
+
+    auto& vector_field = neighbor_vector_field.emplace();
+    vector_field.data_layout     = local.data_layout;
+    vector_field.spacing         = local.spacing;
+    vector_field.offset          = neighbors[i]->offset     .cast<float>().array() * vector_field.spacing.array();
+    vector_field.size            = partitioner_->block_size().cast<float>().array() * vector_field.spacing.array();
+    vector_field.magnitude_scale = reinterpret_cast<const segment_header*>(peer_segment)->magnitude_scale;
+    for_bricked_data(vector_field, [&] (auto& array) { map_segment(array, peer_segment); });
+    shared_neighbors_++;
+  }
+}
+void                      block_sharer::release          ()
+{
+  if (local_vector_field_)
+    local_vector_field_->reset();
+  if (neighbor_vector_fields_)
+    for (auto& vector_field : *neighbor_vector_fields_)
+      vector_field.reset();
+  local_vector_field_     = nullptr;
+  neighbor_vector_fields_ = nullptr;
+
+  if (window_ != MPI_WIN_NULL)
+    MPI_Win_free(&window_);
+}
+
+boost::mpi::communicator* block_sharer::node_communicator()
+{
+  return &node_communicator_;
+}
+std::size_t               block_sharer::shared_neighbors () const
+{
+  return shared_neighbors_;
+}
+}
\ No newline at end of file
@@ -1,9 +1,22 @@
 #include <pa/stages/data_io.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <exception>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
 
+#include <sys/stat.h>
+
+#include <boost/mpi/environment.hpp>
 #include <tbb/tbb.h>
+#include <zlib.h>
 
 #include <pa/math/types.hpp>
 
@@ -19,6 +32,358 @@
 
 namespace pa
 {
+namespace
+{
+// Reads a block slab by slab (one brick along x at a time) and only allocates the bricks which contain a value other than the background.
+// Each slab is read once: its occupied bricks are appended to the storage and filled, and the bricks are reordered along the Morton curve in place at the end.
+// The read_slab(begin, count) function reads the planes [begin, begin + count) and value(x, y, z) accesses the last read slab.
+template <typename type, typename slab_reader_type, typename accessor_type>
+void read_sparse(bricked_array<type>& array, const std::array<std::size_t, 3>& shape, const type& background, const slab_reader_type& read_slab, const accessor_type& value)
+{
+  using bricks = bricked_array<type>;
+
+  array.resize_sparse(shape, background);
+  const auto brick_counts = array.brick_counts();
+
+  const auto for_each_brick = [&] (const auto& function)
+  {
+    tbb::parallel_for(tbb::blocked_range2d<std::size_t>(0, brick_counts[1], 0, brick_counts[2]), [&] (const tbb::blocked_range2d<std::size_t>& index) {
+      for (auto y = index.rows().begin(), y_end = index.rows().end(); y < y_end; ++y) {
+      for (auto z = index.cols().begin(), z_end = index.cols().end(); z < z_end; ++z) {
+        function(y, z,
+          y * bricks::size, std::min((y + 1) * bricks::size, shape[1]),
+          z * bricks::size, std::min((z + 1) * bricks::size, shape[2]));
+      }}
+    });
+  };
+
+  std::vector<std::uint8_t> occupied(brick_counts[1] * brick_counts[2]);
+  for (std::size_t brick_x = 0; brick_x < brick_counts[0]; ++brick_x)
+  {
+    const auto begin = brick_x * bricks::size;
+    const auto count = std::min(bricks::size, shape[0] - begin);
+    read_slab(begin, count);
+
+    std::fill(occupied.begin(), occupied.end(), 0);
+    for_each_brick([&] (const std::size_t brick_y, const std::size_t brick_z, const std::size_t y_begin, const std::size_t y_end, const std::size_t z_begin, const std::size_t z_end)
+    {
+      auto& brick_occupied = occupied[brick_y * brick_counts[2] + brick_z];
+      for (std::size_t x = 0      ; x < count && !brick_occupied; ++x)
+      for (std::size_t y = y_begin; y < y_end && !brick_occupied; ++y)
+      for (std::size_t z = z_begin; z < z_end && !brick_occupied; ++z)
+        brick_occupied = value(x, y, z) != background;
+    });
+
+    for (std::size_t brick_y = 0; brick_y < brick_counts[1]; ++brick_y)
+      for (std::size_t brick_z = 0; brick_z < brick_counts[2]; ++brick_z)
+        if (occupied[brick_y * brick_counts[2] + brick_z])
+          array.allocate(brick_x, brick_y, brick_z);
+
+    for_each_brick([&] (const std::size_t brick_y, const std::size_t brick_z, const std::size_t y_begin, const std::size_t y_end, const std::size_t z_begin, const std::size_t z_end)
+    {
+      if (!occupied[brick_y * brick_counts[2] + brick_z])
+        return;
+      for (std::size_t x = 0      ; x < count; ++x)
+      for (std::size_t y = y_begin; y < y_end; ++y)
+      for (std::size_t z = z_begin; z < z_end; ++z)
+        array(begin + x, y, z) = value(x, y, z);
+    });
+  }
+  array.reorder();
+}
+
+// Reads a block slab by slab (one brick along x at a time) and passes each value to function(x, y, z, slab_x), so that at most a slab is held besides the destination.
+// The read_slab(begin, count) function reads the planes [begin, begin + count), which function accesses at slab_x = x - begin.
+template <typename slab_reader_type, typename function_type>
+void read_slabs(const std::array<std::size_t, 3>& shape, const slab_reader_type& read_slab, const function_type& function)
+{
+  constexpr std::size_t slab_size = bricked_array<vector3>::size;
+
+  for (std::size_t begin = 0; begin < shape[0]; begin += slab_size)
+  {
+    const auto count = std::min(slab_size, shape[0] - begin);
+    read_slab(begin, count);
+
+    tbb::parallel_for(tbb::blocked_range3d<std::size_t>(0, count, 0, shape[1], 0, shape[2]), [&] (const tbb::blocked_range3d<std::size_t>& index) {
+      for (auto x = index.pages().begin(), x_end = index.pages().end(); x < x_end; ++x) {
+      for (auto y = index.rows ().begin(), y_end = index.rows ().end(); y < y_end; ++y) {
+      for (auto z = index.cols ().begin(), z_end = index.cols ().end(); z < z_end; ++z) {
+        function(begin + x, y, z, x);
+      }}}
+    });
+  }
+}
+
+// Reads the hyperslab [offset, offset + count) of a float dataset compressed with deflate (and optionally shuffle) into the destination (row-major).
+// HDF5 decompresses chunks one at a time within its filter pipeline. Instead, the raw chunks are read by direct chunk reads and decompressed in parallel.
+// Returns false without reading if the dataset is not compressed this way, in which case it is to be read through HDF5.
+bool read_compressed(const HighFive::DataSet& dataset, const std::vector<std::size_t>& offset, const std::vector<std::size_t>& count, float* destination)
+{
+  if (tbb::this_task_arena::max_concurrency() < 2) // A single thread decompresses faster within HDF5.
+    return false;
+
+  const auto rank = offset.size();
+
+  std::vector<hsize_t>      chunk  (rank);
+  std::vector<H5Z_filter_t> filters;
+  const auto plist   = H5Dget_create_plist(dataset.getId());
+  const auto chunked = H5Pget_layout(plist) == H5D_CHUNKED && H5Pget_chunk(plist, int(rank), chunk.data()) == int(rank);
+  if (chunked)
+    for (auto i = 0; i < H5Pget_nfilters(plist); ++i)
+    {
+      unsigned flags, configuration;
+      size_t   value_count = 0;
+      filters.push_back(H5Pget_filter2(plist, unsigned(i), &flags, &value_count, nullptr, 0, nullptr, &configuration));
+    }
+  auto fill_value = 0.0f; // Of unallocated chunks. An undefined fill value leaves them zero.
+  if (H5Pget_fill_value(plist, H5T_NATIVE_FLOAT, &fill_value) < 0)
+    fill_value = 0.0f;
+  H5Pclose(plist);
+
+  const auto type     = H5Dget_type(dataset.getId());
+  const auto floating = H5Tequal(type, H5T_NATIVE_FLOAT) > 0;
+  H5Tclose(type);
+
+  if (!chunked || !floating || filters.empty() || std::any_of(filters.begin(), filters.end(), [ ] (const H5Z_filter_t filter) { return filter != H5Z_FILTER_DEFLATE && filter != H5Z_FILTER_SHUFFLE; }))
+    return false;
+
+  std::vector<std::size_t> first(rank), counts(rank);
+  std::size_t chunk_volume = 1;
+  for (std::size_t i = 0; i < rank; ++i)
+  {
+    first [i]     = offset[i] / chunk[i];
+    counts[i]     = (offset[i] + count[i] + chunk[i] - 1) / chunk[i] - first[i];
+    chunk_volume *= chunk[i];
+  }
+
+  // Copies the intersection of the decoded chunk with the hyperslab, one run along the last dimension at a time.
+  const auto scatter = [&] (const std::vector<std::size_t>& chunk_offset, const float* elements)
+  {
+    std::vector<std::size_t> begin(rank), end(rank);
+    for (std::size_t i = 0; i < rank; ++i)
+    {
+      begin[i] = std::max(offset[i], chunk_offset[i]);
+      end  [i] = std::min(offset[i] + count[i], chunk_offset[i] + std::size_t(chunk[i]));
+    }
+
+    auto index = begin;
+    while (true)
+    {
+      std::size_t source = 0, target = 0;
+      for (std::size_t i = 0; i < rank; ++i)
+      {
+        source = source * chunk[i] + (index[i] - chunk_offset[i]);
+        target = target * count[i] + (index[i] - offset      [i]);
+      }
+      if (elements)
+        std::copy_n(elements + source, end[rank - 1] - begin[rank - 1], destination + target);
+      else // Unallocated chunks hold the fill value.
+        std::fill_n(destination + target, end[rank - 1] - begin[rank - 1], fill_value);
+
+      auto i = rank - 1;
+      for (; i > 0; --i)
+      {
+        if (++index[i - 1] < end[i - 1])
+          break;
+        index[i - 1] = begin[i - 1];
+      }
+      if (i == 0)
+        break;
+    }
+  };
+
+  // The chunks are read one plane of chunks at a time (HDF5 is not thread-safe), then decoded and scattered in parallel.
+  tbb::enumerable_thread_specific<std::pair<std::vector<char>, std::vector<char>>> buffers;
+  std::vector<std::vector<std::size_t>> chunk_offsets;
+  std::vector<std::vector<char>>        raw_chunks;
+  std::vector<std::uint32_t>            filter_masks;
+  for (std::size_t x = 0; x < counts[0]; ++x)
+  {
+    chunk_offsets.clear();
+    std::vector<std::size_t> multi_index(rank, 0);
+    multi_index[0] = x;
+    while (true)
+    {
+      std::vector<std::size_t> chunk_offset(rank);
+      for (std::size_t i = 0; i < rank; ++i)
+        chunk_offset[i] = (first[i] + multi_index[i]) * chunk[i];
+      chunk_offsets.push_back(chunk_offset);
+
+      auto i = rank - 1;
+      for (; i > 0; --i)
+      {
+        if (++multi_index[i] < counts[i])
+          break;
+        multi_index[i] = 0;
+      }
+      if (i == 0)
+        break;
+    }
+
+    raw_chunks  .resize(chunk_offsets.size());
+    filter_masks.resize(chunk_offsets.size());
+    for (std::size_t i = 0; i < chunk_offsets.size(); ++i)
+    {
+      const std::vector<hsize_t> chunk_offset(chunk_offsets[i].begin(), chunk_offsets[i].end());
+      hsize_t size = 0;
+      if (H5Dget_chunk_storage_size(dataset.getId(), chunk_offset.data(), &size) < 0)
+        size = 0;
+      raw_chunks[i].resize(size);
+      if (size > 0 && H5Dread_chunk(dataset.getId(), H5P_DEFAULT, chunk_offset.data(), &filter_masks[i], raw_chunks[i].data()) < 0)
+        throw std::runtime_error("Unable to read chunk.");
+    }
+
+    tbb::parallel_for(std::size_t(0), chunk_offsets.size(), [&] (const std::size_t i)
+    {
+      if (raw_chunks[i].empty())
+      {
+        scatter(chunk_offsets[i], nullptr);
+        return;
+      }
+
+      // The filters are undone in reverse order, skipping those flagged in the filter mask.
+      auto& buffer = buffers.local();
+      auto* data   = &raw_chunks[i];
+      for (auto f = filters.size(); f-- > 0;)
+      {
+        if (filter_masks[i] & (1u << f))
+          continue;
+
+        auto& output = data == &buffer.first ? buffer.second : buffer.first;
+        output.resize(chunk_volume * sizeof(float));
+        if (filters[f] == H5Z_FILTER_DEFLATE)
+        {
+          auto length = uLongf(output.size());
+          if (uncompress(reinterpret_cast<Bytef*>(output.data()), &length, reinterpret_cast<const Bytef*>(data->data()), uLong(data->size())) != Z_OK || length != output.size())
+            throw std::runtime_error("Unable to decompress chunk.");
+        }
+        else
+        {
+          for (std::size_t element = 0; element < chunk_volume; ++element)
+            for (std::size_t byte = 0; byte < sizeof(float); ++byte)
+              output[element * sizeof(float) + byte] = (*data)[byte * chunk_volume + element];
+        }
+        data = &output;
+      }
+      if (data->size() != chunk_volume * sizeof(float))
+        throw std::runtime_error("Invalid chunk size.");
+
+      scatter(chunk_offsets[i], reinterpret_cast<const float*>(data->data()));
+    });
+  }
+  return true;
+}
+
+// Reads the hyperslab [offset, offset + count) of a float dataset into the destination (row-major), as part of a collective read of all ranks if requested (parallel HDF5 only).
+// An empty hyperslab reads nothing, yet takes part in the collective read.
+void read_hyperslab(const HighFive::DataSet& dataset, const std::vector<std::size_t>& offset, const std::vector<std::size_t>& count, float* destination, const bool collective)
+{
+  const std::vector<hsize_t> start (offset.begin(), offset.end());
+  const std::vector<hsize_t> extent(count .begin(), count .end());
+  const auto file_space   = H5Dget_space    (dataset.getId());
+  const auto memory_space = H5Screate_simple(int(extent.size()), extent.data(), nullptr);
+  if (std::find(count.begin(), count.end(), 0) != count.end())
+  {
+    H5Sselect_none(file_space  );
+    H5Sselect_none(memory_space);
+  }
+  else
+    H5Sselect_hyperslab(file_space, H5S_SELECT_SET, start.data(), nullptr, extent.data(), nullptr);
+
+  const auto transfer = H5Pcreate(H5P_DATASET_XFER);
+#ifdef H5_HAVE_PARALLEL
+  if (collective)
+    H5Pset_dxpl_mpio(transfer, H5FD_MPIO_COLLECTIVE);
+#else
+  static_cast<void>(collective);
+#endif
+  const auto status = H5Dread(dataset.getId(), H5T_NATIVE_FLOAT, memory_space, file_space, transfer, destination);
+  H5Pclose(transfer    );
+  H5Sclose(memory_space);
+  H5Sclose(file_space  );
+  if (status < 0)
+    throw std::runtime_error("Unable to read hyperslab.");
+}
+
+// Reads the spacing of the dataset, divided by its maximum so that the maximum is 1, and scaled by the downsampling factor of the level.
+vector3 read_spacing(const HighFive::File& file, const std::size_t level)
+{
+  std::array<scalar, 3> raw_spacing;
+  file.getAttribute("spacing").read(raw_spacing);
+  const vector3 spacing(raw_spacing[0], raw_spacing[1], raw_spacing[2]);
+  return spacing / spacing.maxCoeff() * scalar(std::size_t(1) << level);
+}
+
+// Views the bricks of a brick file overlapping the block without copying.
+template <typename type>
+void map_bricks(const brick_file& file, const partitioner::rank_info& rank_info, bricked_array<type>& array)
+{
+  using bricks = bricked_array<type>;
+  static_assert(bricks::size == brick_file::brick_size, "Brick sizes of bricked arrays and brick files must match.");
+
+  if (file.header().components * sizeof(float) != sizeof(type))
+    throw std::runtime_error("Brick file components do not match the field.");
+
+  std::array<std::size_t, 3> shape, origin, first, counts;
+  for (auto i = 0; i < 3; ++i)
+  {
+    shape [i] = std::size_t(rank_info.ghosted_block_size[i]);
+    origin[i] = std::size_t(rank_info.offset[i]) % bricks::size;
+    first [i] = std::size_t(rank_info.offset[i]) / bricks::size;
+    counts[i] = (origin[i] + shape[i] + bricks::size - 1) / bricks::size;
+  }
+
+  std::vector<std::uint32_t> table(counts[0] * counts[1] * counts[2]);
+  for (std::size_t x = 0; x < counts[0]; ++x)
+  for (std::size_t y = 0; y < counts[1]; ++y)
+  for (std::size_t z = 0; z < counts[2]; ++z)
+    table[(x * counts[1] + y) * counts[2] + z] = file.metadata(first[0] + x, first[1] + y, first[2] + z).slot;
+
+  array.map(shape, origin, std::move(table), file.bricks<type>());
+}
+
+// Computes the macro grid of a mapped vector field from the brick metadata, one macro cell per brick, without touching the mapped voxels.
+void compute_macro_grid(const brick_file& file, const partitioner::rank_info& rank_info, vector_field& vector_field)
+{
+  constexpr auto cell_size = brick_file::brick_size;
+
+  std::array<std::size_t, 3> dimensions, offset, macro_dimensions;
+  for (auto i = 0; i < 3; ++i)
+  {
+    dimensions      [i] = std::size_t(rank_info.ghosted_block_size[i]);
+    offset          [i] = std::size_t(rank_info.offset            [i]);
+    macro_dimensions[i] = dimensions[i] > 1 ? (dimensions[i] - 2) / cell_size + 1 : 0;
+  }
+
+  vector_field.macro_cell_size = cell_size;
+  vector_field.macro_grid.resize(macro_dimensions);
+  for (std::size_t x = 0; x < macro_dimensions[0]; ++x)
+  for (std::size_t y = 0; y < macro_dimensions[1]; ++y)
+  for (std::size_t z = 0; z < macro_dimensions[2]; ++z)
+  {
+    // The voxel range of a macro cell is inclusive (see vector_field::compute_macro_grid) and may span the bricks of an unaligned region.
+    std::array<std::size_t, 3> first, last;
+    for (auto i = 0; i < 3; ++i)
+    {
+      const auto index = i == 0 ? x : i == 1 ? y : z;
+      first[i] = (offset[i] + index * cell_size) / cell_size;
+      last [i] = (offset[i] + std::min((index + 1) * cell_size, dimensions[i] - 1)) / cell_size;
+    }
+
+    scalar maximum = 0;
+    for (auto bx = first[0]; bx <= last[0]; ++bx)
+    for (auto by = first[1]; by <= last[1]; ++by)
+    for (auto bz = first[2]; bz <= last[2]; ++bz)
+    {
+      const auto& metadata = file.metadata(bx, by, bz);
+      if (metadata.occupancy > 0)
+        maximum = std::max({maximum, std::abs(metadata.minimum), std::abs(metadata.maximum)});
+    }
+    vector_field.macro_grid[x][y][z] = maximum;
+  }
+}
+}
+
 data_io::data_io(partitioner* partitioner) : partitioner_(partitioner)
 {
 
@@ -26,20 +391,82 @@ data_io::data_io(partitioner* partitioner) : partitioner_(partitioner)
 
 void                                       data_io::set_file                   (const std::string& filepath )
 {
+  wait();
 #ifdef H5_HAVE_PARALLEL
   file_ = std::make_unique<HighFive::File>(filepath, HighFive::File::ReadWrite, HighFive::MPIOFileDriver(*partitioner_->communicator(), MPI_INFO_NULL));
 #else
   file_ = std::make_unique<HighFive::File>(filepath, HighFive::File::ReadWrite);
 #endif
+
+  filepath_ = filepath;
+  brick_files_.clear();
+}
+void                                       data_io::set_scalar_field_layout    (scalar_field::layout layout  )
+{
+  wait();
+  scalar_field_layout_ = layout;
+}
+void                                       data_io::set_vector_field_layout    (vector_field::layout layout  )
+{
+  wait();
+  vector_field_layout_ = layout;
+}
+vector_field::layout                       data_io::vector_field_layout        () const
+{
+  return vector_field_layout_;
+}
+void                                       data_io::set_level                  (const std::size_t    level   )
+{
+  wait();
+  level_               = level ;
+}
+void                                       data_io::set_aggregation            (const std::size_t    reader_count, const std::size_t alignment, const bool collective)
+{
+  wait();
+  reader_count_        = reader_count;
+  alignment_           = alignment   ;
+  collective_          = collective  ;
+}
+std::size_t                                data_io::load_level_count           ()
+{
+  wait();
+
+  if (!file_->exist("levels"))
+    return 1;
+  return 1 + file_->getGroup("levels").getNumberObjects();
 }
 
 ivector3                                   data_io::load_dimensions            ()
 {
-  auto dimensions = file_->getDataSet("vectors").getDimensions();
+  wait();
+
+  auto dimensions = file_->getDataSet(level_name(file_->exist("vectors") ? "vectors" : "time_vectors/0")).getDimensions();
   return ivector3(dimensions[0], dimensions[1], dimensions[2]);
 }
+std::size_t                                data_io::load_time_slice_count      ()
+{
+  wait();
+
+  if (!file_->exist(level_name("time_vectors")))
+    return 0;
+  return file_->getGroup(level_name("time_vectors")).getNumberObjects();
+}
+scalar                                     data_io::load_time_spacing          ()
+{
+  wait();
+
+  auto group = file_->getGroup(level_name("time_vectors"));
+  if (!group.hasAttribute("time_spacing"))
+    return scalar(1);
+
+  scalar time_spacing;
+  group.getAttribute("time_spacing").read(time_spacing);
+  return time_spacing;
+}
 std::optional<scalar_field>                data_io::load_local_scalar_field    (const std::string& name     )
 {
+  wait();
+
   std::optional<scalar_field> scalar_field;
 
   scalar_field.emplace();
@@ -49,81 +476,696 @@ std::optional<scalar_field>                data_io::load_local_scalar_field    (
 }
 std::optional<vector_field>                data_io::load_local_vector_field    ()
 {
+  return load_local_vector_field_into(nullptr);
+}
+std::optional<vector_field>                data_io::load_local_vector_field_into(void* storage)
+{
+  wait();
+
   std::optional<vector_field> vector_field;
 
   vector_field.emplace();
-  load_vector_field(partitioner_->local_rank_info().value(), vector_field);
+  load_vector_field("vectors", partitioner_->local_rank_info().value(), vector_field, reader_count_ > 0 && vector_field_layout_ != vector_field::layout::mapped, storage);
 
   return vector_field;
 }
-std::array<std::optional<vector_field>, 6> data_io::load_neighbor_vector_fields()
+std::optional<vector_field>                data_io::load_local_vector_field    (const std::size_t  time_slice)
 {
-  std::array<std::optional<vector_field>, 6> vector_fields;
+  wait();
+
+  std::optional<vector_field> vector_field;
+
+  vector_field.emplace();
+  load_vector_field("time_vectors/" + std::to_string(time_slice), partitioner_->local_rank_info().value(), vector_field);
 
-  auto& neighbor_rank_info = partitioner_->neighbor_rank_info();
-  for (auto i = 0; i < neighbor_rank_info.size(); ++i)
+  return vector_field;
+}
+std::future<std::optional<vector_field>>   data_io::load_local_vector_field_async(const std::size_t time_slice)
+{
+  wait();
+
+  auto promise = std::make_shared<std::promise<std::optional<vector_field>>>();
+  auto future  = promise->get_future();
+
+  const auto load = [this, time_slice, promise] ()
   {
-    if (!neighbor_rank_info[i])
-      continue;
+    try
+    {
+      std::optional<vector_field> vector_field;
+      vector_field.emplace();
+      load_vector_field("time_vectors/" + std::to_string(time_slice), partitioner_->local_rank_info().value(), vector_field);
+      promise->set_value(std::move(vector_field));
+    }
+    catch (...)
+    {
+      promise->set_exception(std::current_exception());
+    }
+  };
 
-    vector_fields[i].emplace();
-    load_vector_field(neighbor_rank_info[i].value(), vector_fields[i]);
+  if (!can_load_async())
+  {
+    load();
+    return future;
   }
 
+  pending_ = std::async(std::launch::async, load);
+  return future;
+}
+std::array<std::optional<vector_field>, 6> data_io::load_neighbor_vector_fields(const integer depth)
+{
+  wait();
+
+  std::array<std::optional<vector_field>, 6> vector_fields;
+
+  for (std::size_t i = 0; i < vector_fields.size(); ++i)
+    load_neighbor_vector_field(i, depth, vector_fields[i]);
+
   return vector_fields;
 }
+std::optional<vector_field>                data_io::load_neighbor_vector_field (const std::size_t index, const integer depth)
+{
+  wait();
+
+  std::optional<vector_field> vector_field;
+  load_neighbor_vector_field(index, depth, vector_field);
+  return vector_field;
+}
+std::array<std::shared_future<void>, 6>    data_io::load_neighbor_vector_fields_async(std::array<std::optional<vector_field>, 6>* vector_fields, const integer depth)
+{
+  wait();
+
+  auto promises = std::make_shared<std::array<std::promise<void>, 6>>();
+  std::array<std::shared_future<void>, 6> futures;
+  for (std::size_t i = 0; i < futures.size(); ++i)
+  {
+    futures[i] = (*promises)[i].get_future().share();
+    (*vector_fields)[i].reset();
+  }
+
+  const auto load = [this, vector_fields, promises, depth] ()
+  {
+    for (std::size_t i = 0; i < vector_fields->size(); ++i)
+    {
+      try
+      {
+        load_neighbor_vector_field(i, depth, (*vector_fields)[i]);
+        (*promises)[i].set_value();
+      }
+      catch (...)
+      {
+        (*promises)[i].set_exception(std::current_exception());
+      }
+    }
+  };
+
+  if (!can_load_async())
+  {
+    load();
+    return futures;
+  }
+
+  pending_ = std::async(std::launch::async, load);
+  return futures;
+}
+std::optional<vector_field>                data_io::load_vector_field_block    (const ivector3& offset, const ivector3& size, const std::string& cache_directory)
+{
+  wait();
+
+  std::optional<vector_field> vector_field;
+  load_vector_field_block(offset, size, cache_directory, vector_field);
+  return vector_field;
+}
+std::future<std::optional<vector_field>>   data_io::load_vector_field_block_async(const ivector3& offset, const ivector3& size, const std::string& cache_directory)
+{
+  wait();
+
+  auto promise = std::make_shared<std::promise<std::optional<vector_field>>>();
+  auto future  = promise->get_future();
+
+  const auto load = [this, offset, size, cache_directory, promise] ()
+  {
+    try
+    {
+      std::optional<vector_field> vector_field;
+      load_vector_field_block(offset, size, cache_directory, vector_field);
+      promise->set_value(std::move(vector_field));
+    }
+    catch (...)
+    {
+      promise->set_exception(std::current_exception());
+    }
+  };
+
+  if (!can_load_async())
+  {
+    load();
+    return future;
+  }
+
+  pending_ = std::async(std::launch::async, load);
+  return future;
+}
+bool                                       data_io::can_load_async             () const
+{
+#ifdef H5_HAVE_PARALLEL
+  // Parallel HDF5 reads issue MPI calls from the loading thread, which requires full MPI thread support.
+  return boost::mpi::environment::thread_level() == boost::mpi::threading::multiple;
+#else
+  return true;
+#endif
+}
+vector3                                    data_io::load_spacing               ()
+{
+  wait();
+  return read_spacing(*file_, level_);
+}
 
 void                                       data_io::load_scalar_field          (const std::string& name, const partitioner::rank_info& rank_info, std::optional<scalar_field>& scalar_field)
 {
-  file_->getDataSet(name).select(
-    {std::size_t(rank_info.offset            [0]), std::size_t(rank_info.offset            [1]), std::size_t(rank_info.offset            [2])},
-    {std::size_t(rank_info.ghosted_block_size[0]), std::size_t(rank_info.ghosted_block_size[1]), std::size_t(rank_info.ghosted_block_size[2])},
-    {1, 1, 1}).read(scalar_field->data);
+  const auto path = level_name(name);
+
+  scalar_field->data_layout = scalar_field_layout_;
+  if      (scalar_field_layout_ == scalar_field::layout::mapped)
+    map_bricks(load_brick_file(path), rank_info, scalar_field->sparse_data);
+  else if (scalar_field_layout_ == scalar_field::layout::sparse)
+  {
+    auto                          dataset = file_->getDataSet(path);
+    boost::multi_array<scalar, 3> slab;
+    read_sparse(scalar_field->sparse_data,
+      {std::size_t(rank_info.ghosted_block_size[0]), std::size_t(rank_info.ghosted_block_size[1]), std::size_t(rank_info.ghosted_block_size[2])},
+      scalar(0),
+      [&] (const std::size_t begin, const std::size_t count)
+      {
+        const std::vector<std::size_t> offset {std::size_t(rank_info.offset[0]) + begin, std::size_t(rank_info.offset            [1]), std::size_t(rank_info.offset            [2])};
+        const std::vector<std::size_t> extent {count                                   , std::size_t(rank_info.ghosted_block_size[1]), std::size_t(rank_info.ghosted_block_size[2])};
+        slab.resize(boost::extents[extent[0]][extent[1]][extent[2]]);
+        if (!read_compressed(dataset, offset, extent, slab.data()))
+          dataset.select(offset, extent, {1, 1, 1}).read(slab);
+      },
+      [&] (const std::size_t x, const std::size_t y, const std::size_t z)
+      {
+        return slab[x][y][z];
+      });
+  }
+  else
+  {
+    // 8 and 16-bit unsigned integer datasets are read without conversion.
+    auto       dataset   = file_->getDataSet(path);
+    const auto selection = dataset.select(
+      {std::size_t(rank_info.offset            [0]), std::size_t(rank_info.offset            [1]), std::size_t(rank_info.offset            [2])},
+      {std::size_t(rank_info.ghosted_block_size[0]), std::size_t(rank_info.ghosted_block_size[1]), std::size_t(rank_info.ghosted_block_size[2])},
+      {1, 1, 1});
+    const auto data_type = dataset.getDataType();
+    if      (data_type == HighFive::AtomicType<std::uint8_t >())
+    {
+      scalar_field->data_layout = scalar_field::layout::linear_8;
+      selection.read(scalar_field->data_8 );
+    }
+    else if (data_type == HighFive::AtomicType<std::uint16_t>())
+    {
+      scalar_field->data_layout = scalar_field::layout::linear_16;
+      selection.read(scalar_field->data_16);
+    }
+    else
+    {
+      scalar_field->data_layout = scalar_field::layout::linear;
+      scalar_field->data.resize(boost::extents[rank_info.ghosted_block_size[0]][rank_info.ghosted_block_size[1]][rank_info.ghosted_block_size[2]]);
+      if (!read_compressed(dataset, 
+        {std::size_t(rank_info.offset            [0]), std::size_t(rank_info.offset            [1]), std::size_t(rank_info.offset            [2])},
+        {std::size_t(rank_info.ghosted_block_size[0]), std::size_t(rank_info.ghosted_block_size[1]), std::size_t(rank_info.ghosted_block_size[2])},
+        scalar_field->data.data()))
+        selection.read(scalar_field->data);
+    }
+  }
   
-  std::array<scalar, 3> raw_spacing;
-  file_->getAttribute("spacing").read(raw_spacing);
-  scalar_field->spacing  = vector3(raw_spacing[0], raw_spacing[1], raw_spacing[2]);
-  scalar_field->spacing /= scalar_field->spacing.maxCoeff(); // Divide by maximum so that the maximum is 1.
+  scalar_field->spacing = read_spacing(*file_, level_);
 
   scalar_field->offset = rank_info.offset          .cast<float>().array() * scalar_field->spacing.array();
   scalar_field->size   = partitioner_->block_size().cast<float>().array() * scalar_field->spacing.array();
 }
-void                                       data_io::load_vector_field          (                         const partitioner::rank_info& rank_info, std::optional<vector_field>& vector_field)
+void                                       data_io::load_vector_field          (const std::string& name, const partitioner::rank_info& rank_info, std::optional<vector_field>& vector_field, const bool aggregated, void* storage)
 {
-  boost::multi_array<scalar, 4> data;
-  file_->getDataSet("vectors").select(
-    {std::size_t(rank_info.offset            [0]), std::size_t(rank_info.offset            [1]), std::size_t(rank_info.offset            [2]), 0},
-    {std::size_t(rank_info.ghosted_block_size[0]), std::size_t(rank_info.ghosted_block_size[1]), std::size_t(rank_info.ghosted_block_size[2]), 3},
-    {1, 1, 1, 1}).read(data);
-  
-  vector_field->data.resize(std::array<integer, 3>{rank_info.ghosted_block_size[0], rank_info.ghosted_block_size[1], rank_info.ghosted_block_size[2]});
-  tbb::parallel_for(tbb::blocked_range3d<std::size_t>(0, rank_info.ghosted_block_size[0], 0, rank_info.ghosted_block_size[1], 0, rank_info.ghosted_block_size[2]), [&] (const tbb::blocked_range3d<std::size_t>& index) {
-    for (auto x = index.pages().begin(), x_end = index.pages().end(); x < x_end; ++x) {
-    for (auto y = index.rows ().begin(), y_end = index.rows ().end(); y < y_end; ++y) {
-    for (auto z = index.cols ().begin(), z_end = index.cols ().end(); z < z_end; ++z) {
-      vector_field->data[x][y][z] = {data[x][y][z][0], data[x][y][z][1], data[x][y][z][2]};
-    }}}
-  });
+  const auto path = level_name(name);
+
+  const std::array<std::size_t, 3> shape {std::size_t(rank_info.ghosted_block_size[0]), std::size_t(rank_info.ghosted_block_size[1]), std::size_t(rank_info.ghosted_block_size[2])};
+
+  // Runs a pass over the slabs of the region. If aggregated, the pass reads them from the reader of this rank, as a collective aggregate_block each.
+  const plane_reader* aggregate = nullptr;
+  const auto pass = [&] (const auto& function)
+  {
+    if (!aggregated)
+    {
+      function();
+      return;
+    }
+    aggregate_block(name, [&] (const plane_reader& reader)
+    {
+      aggregate = &reader;
+      function();
+      aggregate = nullptr;
+    });
+  };
+  // Reads the planes [begin, begin + count) of the region into the slab.
+  const auto read_planes = [&] (const HighFive::DataSet& dataset, const std::size_t begin, const std::size_t count, boost::multi_array<scalar, 4>& slab)
+  {
+    slab.resize(boost::extents[count][shape[1]][shape[2]][3]);
+    if (aggregate)
+    {
+      (*aggregate)(begin, count, slab.data());
+      return;
+    }
+    const std::vector<std::size_t> offset {std::size_t(rank_info.offset[0]) + begin, std::size_t(rank_info.offset            [1]), std::size_t(rank_info.offset            [2]), 0};
+    const std::vector<std::size_t> extent {count                                   , std::size_t(rank_info.ghosted_block_size[1]), std::size_t(rank_info.ghosted_block_size[2]), 3};
+    if (!read_compressed(dataset, offset, extent, slab.data()))
+      dataset.select(offset, extent, {1, 1, 1, 1}).read(slab);
+  };
+
+  vector_field->data_layout = vector_field_layout_;
+  if      (vector_field_layout_ == vector_field::layout::mapped)
+  {
+    map_bricks        (load_brick_file(path), rank_info, vector_field->bricked_data);
+    compute_macro_grid(load_brick_file(path), rank_info, *vector_field);
+  }
+  else if (vector_field_layout_ == vector_field::layout::sparse)
+  {
+    auto                          dataset = file_->getDataSet(path);
+    boost::multi_array<scalar, 4> slab;
+    pass([&] ()
+    {
+      read_sparse(vector_field->bricked_data, shape, vector3(vector3::Zero()),
+        [&] (const std::size_t begin, const std::size_t count)
+        {
+          read_planes(dataset, begin, count, slab);
+        },
+        [&] (const std::size_t x, const std::size_t y, const std::size_t z)
+        {
+          return vector3(slab[x][y][z][0], slab[x][y][z][1], slab[x][y][z][2]);
+        });
+    });
+  }
+  else if (vector_field_layout_ == vector_field::layout::linear)
+  {
+    // The file layout matches the memory layout of vector3, hence the hyperslab is read in place.
+    static_assert(sizeof(vector3) == 3 * sizeof(scalar), "Vectors must be tightly packed.");
+    vector_field->data.resize(std::array<integer, 3>{rank_info.ghosted_block_size[0], rank_info.ghosted_block_size[1], rank_info.ghosted_block_size[2]});
+    const std::vector<std::size_t> offset {std::size_t(rank_info.offset            [0]), std::size_t(rank_info.offset            [1]), std::size_t(rank_info.offset            [2]), 0};
+    const std::vector<std::size_t> count  {std::size_t(rank_info.ghosted_block_size[0]), std::size_t(rank_info.ghosted_block_size[1]), std::size_t(rank_info.ghosted_block_size[2]), 3};
+    auto dataset = file_->getDataSet(path);
+    if      (aggregated)
+      aggregate_block(name, [&] (const plane_reader& reader) { reader(0, shape[0], vector_field->data.data()->data()); });
+    else if (!read_compressed(dataset, offset, count, vector_field->data.data()->data()))
+      dataset.select(offset, count, {1, 1, 1, 1}).read(vector_field->data.data()->data());
+  }
+  else
+  {
+    auto                          dataset = file_->getDataSet(path);
+    boost::multi_array<scalar, 4> slab;
+    const auto fill = [&] (const auto& function)
+    {
+      pass([&] ()
+      {
+        read_slabs(shape,
+          [&] (const std::size_t begin, const std::size_t count)
+          {
+            read_planes(dataset, begin, count, slab);
+          },
+          [&] (const std::size_t x, const std::size_t y, const std::size_t z, const std::size_t slab_x)
+          {
+            function(x, y, z, vector3(slab[slab_x][y][z][0], slab[slab_x][y][z][1], slab[slab_x][y][z][2]));
+          });
+      });
+    };
+
+    if      (vector_field_layout_ == vector_field::layout::bricked)
+    {
+      storage ? vector_field->bricked_data.resize(shape, static_cast<vector3*>(storage)) : vector_field->bricked_data.resize(shape);
+      fill([&] (const std::size_t x, const std::size_t y, const std::size_t z, const vector3& value) { vector_field->bricked_data(x, y, z) = value; });
+    }
+    else if (vector_field_layout_ == vector_field::layout::bricked_half)
+    {
+      storage ? vector_field->half_data.resize(shape, static_cast<half_vector3*>(storage)) : vector_field->half_data.resize(shape);
+      fill([&] (const std::size_t x, const std::size_t y, const std::size_t z, const vector3& value) { vector_field->half_data(x, y, z) = half_vector3::encode(value); });
+    }
+    else if (vector_field_layout_ == vector_field::layout::bricked_octahedral)
+    {
+      // Magnitudes are quantized relative to the largest magnitude within the block (ghost cells included).
+      // The slabs are read twice (aggregated twice, if aggregated) rather than holding the whole block in single precision.
+      tbb::combinable<scalar> maximum_magnitude([ ] () { return scalar(0); });
+      fill([&] (const std::size_t, const std::size_t, const std::size_t, const vector3& value) { auto& maximum = maximum_magnitude.local(); maximum = std::max(maximum, value.norm()); });
+      const auto magnitude = maximum_magnitude.combine([ ] (const scalar lhs, const scalar rhs) { return std::max(lhs, rhs); });
+
+      vector_field->magnitude_scale = magnitude > scalar(0) ? magnitude : scalar(1);
+      storage ? vector_field->octahedral_data.resize(shape, static_cast<octahedral_vector3*>(storage)) : vector_field->octahedral_data.resize(shape);
+      fill([&] (const std::size_t x, const std::size_t y, const std::size_t z, const vector3& value) { vector_field->octahedral_data(x, y, z) = octahedral_vector3::encode(value, vector_field->magnitude_scale); });
+    }
+  }
   
-  std::array<scalar, 3> raw_spacing;
-  file_->getAttribute("spacing").read(raw_spacing);
-  vector_field->spacing  = vector3(raw_spacing[0], raw_spacing[1], raw_spacing[2]);
-  vector_field->spacing /= vector_field->spacing.maxCoeff(); // Divide by maximum so that the maximum is 1.
+  vector_field->spacing = read_spacing(*file_, level_);
 
   vector_field->offset = rank_info.offset          .cast<float>().array() * vector_field->spacing.array();
   vector_field->size   = partitioner_->block_size().cast<float>().array() * vector_field->spacing.array();
+
+  // The macro grid of mapped fields is read from the brick metadata, since scanning the voxels would fault in every page.
+  if (vector_field_layout_ != vector_field::layout::mapped)
+    vector_field->compute_macro_grid();
+}
+void                                       data_io::load_neighbor_vector_field (const std::size_t  index , const integer                 depth    , std::optional<vector_field>& vector_field)
+{
+  auto& neighbor_rank_info = partitioner_->neighbor_rank_info()[index];
+  if (!neighbor_rank_info)
+    return;
+
+  auto       rank_info = neighbor_rank_info.value();
+  const auto axis      = index / 2;
+  const auto block     = partitioner_->block_size()[axis];
+  const auto slab      = depth > 0 && depth < block;
+  if (slab)
+  {
+    // The slab of a lower neighbor ends with its one voxel ghost region (the first voxel of this block), the slab of an upper neighbor closes its last cell with one more voxel.
+    if (index % 2 == 0)
+      rank_info.offset[axis] += block - depth;
+    rank_info.ghosted_block_size[axis] = depth + 1;
+  }
+
+  vector_field.emplace();
+  load_vector_field("vectors", rank_info, vector_field);
+
+  if (slab)
+    vector_field->size[axis] = scalar(depth) * vector_field->spacing[axis];
+}
+void                                       data_io::load_vector_field_block    (const ivector3&    offset, const ivector3&               size     , const std::string& cache_directory, std::optional<vector_field>& vector_field)
+{
+  // The block is positioned at the origin of its brick file.
+  partitioner::rank_info rank_info(0, ivector3::Ones(), size);
+  for (auto i = 0; i < 3; ++i)
+    if (offset[i] + size[i] < partitioner_->domain_size()[i])
+      rank_info.ghosted_block_size[i]++;
+
+  const std::array<std::size_t, 3> origin {std::size_t(offset                        [0]), std::size_t(offset                        [1]), std::size_t(offset                        [2])};
+  const std::array<std::size_t, 3> shape  {std::size_t(rank_info.ghosted_block_size[0]), std::size_t(rank_info.ghosted_block_size[1]), std::size_t(rank_info.ghosted_block_size[2])};
+
+  // The name includes a hash of the full path, since datasets of equal names in different directories share the cache directory.
+  auto name = level_name("vectors");
+  std::replace(name.begin(), name.end(), '/', '_');
+  std::ostringstream path_hash;
+  path_hash << std::hex << std::hash<std::string>()(filepath_);
+  const auto filepath = cache_directory + "/" + filepath_.substr(filepath_.find_last_of("/\\") + 1) + "." + path_hash.str() + "." + name + "." +
+    std::to_string(origin[0]) + "_" + std::to_string(origin[1]) + "_" + std::to_string(origin[2]) + "." +
+    std::to_string(shape [0]) + "_" + std::to_string(shape [1]) + "_" + std::to_string(shape [2]) + ".bricks";
+
+  // The size and modification time of the dataset identify its version, so that brick files of a modified dataset are not reused.
+  struct stat source;
+  if (stat(filepath_.c_str(), &source) != 0)
+    throw std::runtime_error("Unable to stat " + filepath_ + ".");
+  const auto source_size = std::uint64_t(source.st_size );
+  const auto source_time = std::uint64_t(source.st_mtime);
+
+  // A missing, truncated, mismatching or stale brick file (e.g. of an interrupted run) is recreated.
+  std::unique_ptr<brick_file> file;
+  try
+  {
+    file = std::make_unique<brick_file>(filepath);
+    if (file->header().source_size != source_size || file->header().source_time != source_time)
+      file.reset();
+    for (auto i = 0; file && i < 3; ++i)
+      if (file->header().shape[i] != shape[i])
+        file.reset();
+  }
+  catch (const std::exception&)
+  {
+    file.reset();
+  }
+  if (!file)
+  {
+    brick_file::create(file_->getDataSet(level_name("vectors")), filepath, origin, shape, source_size, source_time);
+    file = std::make_unique<brick_file>(filepath);
+  }
+
+  // The vector field shares the ownership of the mapping, hence the brick file may be closed.
+  vector_field.emplace();
+  vector_field->data_layout = vector_field::layout::mapped;
+  map_bricks        (*file, rank_info, vector_field->bricked_data);
+  compute_macro_grid(*file, rank_info, *vector_field);
+
+  vector_field->spacing = read_spacing(*file_, level_);
+  vector_field->offset  = offset.cast<float>().array() * vector_field->spacing.array();
+  vector_field->size    = size  .cast<float>().array() * vector_field->spacing.array();
+}
+  
+void                                       data_io::aggregate_block            (const std::string& name  , const std::function<void(const plane_reader&)>& load)
+{
+  auto&      communicator = *partitioner_->communicator();
+  const auto rank         = std::size_t(communicator.rank());
+  const auto rank_count   = std::size_t(communicator.size());
+  const auto reader_count = std::min(reader_count_, rank_count);
+  auto       dataset      = file_->getDataSet(level_name(name));
+  const auto dimensions   = dataset.getDimensions();
+
+  // Aligns to the chunks of the dataset unless an alignment is given.
+  std::array<std::size_t, 3> alignment {1, 1, 1};
+  if (alignment_ > 0)
+    alignment.fill(alignment_);
+  else
+  {
+    std::array<hsize_t, 4> chunk {};
+    const auto plist = H5Dget_create_plist(dataset.getId());
+    if (H5Pget_layout(plist) == H5D_CHUNKED && H5Pget_chunk(plist, int(chunk.size()), chunk.data()) == int(chunk.size()))
+      std::copy_n(chunk.begin(), 3, alignment.begin());
+    H5Pclose(plist);
+  }
+
+  // The ranks are divided into contiguous groups, each served by its first rank. The reader reads the region of each member separately, aligned outwards,
+  // hence no voxels outside the regions of the group are read. Each region is read in slabs of at most 64 planes, fewer if a slab would exceed the byte cap.
+  // Slabs span whole chunks along x if one fits within the cap, else they split the chunks, which are then read once per slab.
+  constexpr std::size_t maximum_slab_size     = 64;
+  constexpr std::size_t maximum_slab_elements = (std::size_t(256) << 20) / sizeof(scalar);
+  constexpr std::size_t maximum_message_size  = std::size_t(1) << 30; // Elements per message, within the int count of MPI.
+  constexpr std::size_t brick_size            = bricked_array<vector3>::size;
+
+  const auto group_begin = [&] (const std::size_t group ) { return (group * rank_count + reader_count - 1) / reader_count; };
+  const auto region      = [&] (const std::size_t member)
+  {
+    return partitioner::rank_info(integer(member), partitioner_->grid_size(), partitioner_->block_size(), partitioner_->ghost_width());
+  };
+  const auto member_box  = [&] (const std::size_t member)
+  {
+    const auto info = region(member);
+    std::array<std::size_t, 3> lower, upper;
+    for (auto i = 0; i < 3; ++i)
+    {
+      lower[i] = std::size_t(info.offset[i]) / alignment[i] * alignment[i];
+      upper[i] = std::min((std::size_t(info.offset[i] + info.ghosted_block_size[i]) + alignment[i] - 1) / alignment[i] * alignment[i], dimensions[i]);
+    }
+    return std::make_pair(lower, upper);
+  };
+  const auto slab_size   = [&] (const std::size_t member)
+  {
+    const auto box            = member_box(member);
+    const auto plane_elements = std::max<std::size_t>(1, (box.second[1] - box.first[1]) * (box.second[2] - box.first[2]) * 3);
+    const auto planes         = std::max<std::size_t>(1, std::min(maximum_slab_size, maximum_slab_elements / plane_elements));
+    return planes >= alignment[0] ? planes / alignment[0] * alignment[0] : planes;
+  };
+  const auto slab_count  = [&] (const std::size_t member)
+  {
+    const auto box = member_box(member);
+    return (box.second[0] - box.first[0] + slab_size(member) - 1) / slab_size(member);
+  };
+  // The index of the first slab of the member among the slabs read by its reader.
+  const auto first_read  = [&] (const std::size_t member)
+  {
+    std::size_t read = 0;
+    for (auto other = group_begin(member * reader_count / rank_count); other < member; ++other)
+      read += slab_count(other);
+    return read;
+  };
+  // Calls function(slab, begin, end) for each piece of the region of the member in order, i.e. the planes [begin, end) of the region (relative to it)
+  // within a slab, split at the brick slabs of the region so that the member receives each brick slab on its own.
+  const auto pieces      = [&] (const std::size_t member, const auto& function)
+  {
+    const auto info   = region    (member);
+    const auto box    = member_box(member);
+    const auto offset = std::size_t(info.offset[0]);
+    for (std::size_t slab = 0; slab < slab_count(member); ++slab)
+    {
+      const auto begin = std::max(box.first[0] + slab * slab_size(member), offset);
+      const auto end   = std::min(std::min(box.first[0] + (slab + 1) * slab_size(member), box.second[0]), offset + std::size_t(info.ghosted_block_size[0]));
+      for (auto piece = begin; piece < end;)
+      {
+        const auto next = std::min(end, offset + ((piece - offset) / brick_size + 1) * brick_size);
+        function(slab, piece - offset, next - offset);
+        piece = next;
+      }
+    }
+  };
+  // Calls function(offset, count, tag) for each message of a piece of elements, and returns the tag following the last.
+  const auto messages    = [&] (const std::size_t elements, int tag, const auto& function)
+  {
+    for (std::size_t offset = 0; offset < elements; offset += maximum_message_size)
+      function(offset, std::min(maximum_message_size, elements - offset), tag++);
+    return tag;
+  };
+
+  const auto group  = rank * reader_count / rank_count;
+  const auto reader = group_begin(group);
+  const auto local  = region(rank);
+  const auto plane  = std::size_t(local.ghosted_block_size[1]) * std::size_t(local.ghosted_block_size[2]) * 3;
+  const auto first  = first_read(rank);
+
+  // Collective reads require all ranks to take part in as many reads as the reader with the most slabs.
+  std::size_t rounds = 0;
+  if (collective_)
+    for (std::size_t other = 0; other < reader_count; ++other)
+      rounds = std::max(rounds, first_read(group_begin(other + 1) - 1) + slab_count(group_begin(other + 1) - 1));
+
+  // Reads the next slab of the member (the reads of the reader are counted across its members).
+  std::size_t                reads = 0;
+  std::vector<scalar>        slab_data;
+  std::array<std::size_t, 3> extent {};
+  const auto read_slab = [&] (const std::size_t member)
+  {
+    const auto box     = member_box(member);
+    const auto x_begin = box.first[0] + (reads - first_read(member)) * slab_size(member);
+    const auto x_end   = std::min(x_begin + slab_size(member), box.second[0]);
+    extent = {x_end - x_begin, box.second[1] - box.first[1], box.second[2] - box.first[2]};
+    slab_data.resize(extent[0] * extent[1] * extent[2] * 3);
+
+    // Collective reads are left to parallel HDF5, since every rank takes part in them.
+    const std::vector<std::size_t> hyperslab_offset {x_begin  , box.first[1], box.first[2], 0};
+    const std::vector<std::size_t> hyperslab_count  {extent[0], extent[1]   , extent[2]   , 3};
+    if (collective_ || !read_compressed(dataset, hyperslab_offset, hyperslab_count, slab_data.data()))
+      read_hyperslab(dataset, hyperslab_offset, hyperslab_count, slab_data.data(), collective_);
+    ++reads;
+  };
+  // Copies the planes [begin, end) of the region of the member from its last read slab into the target.
+  const auto copy      = [&] (const std::size_t member, const std::size_t begin, const std::size_t end, scalar* target)
+  {
+    const auto info    = region    (member);
+    const auto box     = member_box(member);
+    const auto x_begin = box.first[0] + (reads - 1 - first_read(member)) * slab_size(member);
+    const auto rows    = std::size_t(info.ghosted_block_size[1]);
+    const auto run     = std::size_t(info.ghosted_block_size[2]) * 3;
+    tbb::parallel_for(begin, end, [&] (const std::size_t x)
+    {
+      for (std::size_t y = 0; y < rows; ++y)
+        std::copy_n(
+          slab_data.data() + (((info.offset[0] + x - x_begin) * extent[1] + info.offset[1] + y - box.first[1]) * extent[2] + info.offset[2] - box.first[2]) * 3,
+          run,
+          target + ((x - begin) * rows + y) * run);
+    });
+  };
+
+  // The pieces of the local region, read by the reader of this rank or received from it, straight into the destination of the load.
+  std::vector<std::array<std::size_t, 3>> local_pieces;
+  pieces(rank, [&] (const std::size_t slab, const std::size_t begin, const std::size_t end) { local_pieces.push_back({slab, begin, end}); });
+
+  std::size_t next = 0;
+  auto        tag  = 0;
+  const plane_reader read_planes = [&] (const std::size_t begin, const std::size_t count, scalar* destination)
+  {
+    for (; next < local_pieces.size() && local_pieces[next][1] < begin + count; ++next)
+    {
+      const auto& piece = local_pieces[next];
+      if (piece[1] < begin || piece[2] > begin + count)
+        throw std::runtime_error("Aggregated planes must be read in order, in brick slabs or at once.");
+
+      const auto target = destination + (piece[1] - begin) * plane;
+      if (rank == reader)
+      {
+        while (reads <= piece[0])
+          read_slab(rank);
+        copy(rank, piece[1], piece[2], target);
+        continue;
+      }
+
+      // The reader sends the piece once it read its slab, hence the collective reads up to it are taken part in first.
+      for (; reads < std::min(first + piece[0] + 1, rounds); ++reads)
+        read_hyperslab(dataset, {0, 0, 0, 0}, {0, 0, 0, 0}, nullptr, collective_);
+      std::vector<boost::mpi::request> requests;
+      tag = messages((piece[2] - piece[1]) * plane, tag, [&] (const std::size_t offset, const std::size_t count, const int message_tag)
+      {
+        requests.push_back(communicator.irecv(int(reader), message_tag, target + offset, int(count)));
+      });
+      boost::mpi::wait_all(requests.begin(), requests.end());
+    }
+  };
+  load(read_planes);
+
+  // Pieces left unread by the load are drained, so that the sends of the reader complete.
+  std::vector<scalar> drained;
+  while (next < local_pieces.size())
+  {
+    const auto& piece = local_pieces[next];
+    drained.resize((piece[2] - piece[1]) * plane);
+    read_planes(piece[1], piece[2] - piece[1], drained.data());
+  }
+
+  // The reader then serves the other members of its group, one piece at a time.
+  if (rank == reader)
+  {
+    while (reads < slab_count(rank))
+      read_slab(rank);
+
+    std::vector<scalar> send_data;
+    for (auto member = reader + 1; member < group_begin(group + 1); ++member)
+    {
+      const auto member_plane = std::size_t(region(member).ghosted_block_size[1]) * std::size_t(region(member).ghosted_block_size[2]) * 3;
+      auto       member_tag   = 0;
+      pieces(member, [&] (const std::size_t slab, const std::size_t begin, const std::size_t end)
+      {
+        while (reads <= first_read(member) + slab)
+          read_slab(member);
+
+        send_data.resize((end - begin) * member_plane);
+        copy(member, begin, end, send_data.data());
+
+        std::vector<boost::mpi::request> send_requests;
+        member_tag = messages(send_data.size(), member_tag, [&] (const std::size_t offset, const std::size_t count, const int message_tag)
+        {
+          send_requests.push_back(communicator.isend(int(member), message_tag, send_data.data() + offset, int(count)));
+        });
+        boost::mpi::wait_all(send_requests.begin(), send_requests.end());
+      });
+      while (reads < first_read(member) + slab_count(member))
+        read_slab(member);
+    }
+  }
+  for (; reads < rounds; ++reads)
+    read_hyperslab(dataset, {0, 0, 0, 0}, {0, 0, 0, 0}, nullptr, collective_);
+}
+const brick_file&                          data_io::load_brick_file            (const std::string& name)
+{
+  auto& file = brick_files_[name];
+  if (!file)
+  {
+    auto filename = name;
+    std::replace(filename.begin(), filename.end(), '/', '_');
+    file = std::make_unique<brick_file>(filepath_ + "." + filename + ".bricks");
+  }
+  return *file;
+}
+std::string                                data_io::level_name                 (const std::string& name) const
+{
+  return level_ == 0 ? name : "levels/" + std::to_string(level_) + "/" + name;
+}
+void                                       data_io::wait                       ()
+{
+  if (pending_.valid())
+    pending_.get();
 }
   
 void                                       data_io::save_ftle_field            (const std::string& name    , scalar_field*                 ftle_field     )
 {
+  wait();
+
   auto& rank_info  = partitioner_->local_rank_info();
   auto  offset     = rank_info->offset;
   auto  size       = ftle_field->data.shape();
   auto  total_size = partitioner_->domain_size();
 
-  if (file_->exist(name))
+  const auto path = level_name(name);
+  if (file_->exist(path))
   {
-    auto dataset = file_->getDataSet(name);
+    auto dataset = file_->getDataSet(path);
     //dataset.resize({std::size_t(total_size[0]), std::size_t(total_size[1]), std::size_t(total_size[2])});
     dataset.select({std::size_t(offset    [0]), std::size_t(offset    [1]), std::size_t(offset    [2])}, 
                    {std::size_t(size      [0]), std::size_t(size      [1]), std::size_t(size      [2])}, 
@@ -131,7 +1173,7 @@ void                                       data_io::save_ftle_field            (
   }
   else
   {
-    auto dataset = file_->createDataSet<float>(name, HighFive::DataSpace(
+    auto dataset = file_->createDataSet<float>(path, HighFive::DataSpace(
                    {std::size_t(total_size[0]), std::size_t(total_size[1]), std::size_t(total_size[2])}));
     dataset.select({std::size_t(offset    [0]), std::size_t(offset    [1]), std::size_t(offset    [2])}, 
                    {std::size_t(size      [0]), std::size_t(size      [1]), std::size_t(size      [2])}, 
@@ -198,4 +1240,4 @@ void                                       data_io::save_integral_curves       (
   throw std::runtime_error("Unable to save integral curves: Built without VTK support.");
 #endif
 }
-}
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include <pa/stages/derived_field_generator.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+#include <tbb/tbb.h>
+
+#include <pa/math/gradient_stencil.hpp>
+
+namespace pa
+{
+namespace
+{
+constexpr std::size_t row_size = 512; // Voxels per tile along z.
+}
+
+derived_field_generator::derived_field_generator(const mode mode, const std::size_t tile_size) : mode_(mode), tile_size_(tile_size)
+{
+
+}
+
+void                          derived_field_generator::set_mode        (const mode          mode        )
+{
+  mode_ = mode;
+}
+void                          derived_field_generator::set_tile_size   (const std::size_t   tile_size   )
+{
+  tile_size_ = tile_size;
+}
+void                          derived_field_generator::set_vector_field(const vector_field* vector_field)
+{
+  vector_field_ = vector_field;
+}
+
+std::unique_ptr<scalar_field> derived_field_generator::generate        () const
+{
+  if (!vector_field_)
+    throw std::runtime_error("Derived field generator has no vector field.");
+
+  // The ghost layers are cropped, leaving the block and the voxel shared with each positive neighbor.
+  const auto shape = vector_field_->shape();
+  std::array<std::size_t, 3> begin, end;
+  for (auto i = 0; i < 3; ++i)
+  {
+    begin[i] = std::min(std::size_t(vector_field_->lower_ghost_width[i]), shape[i]);
+    end  [i] = std::min(begin[i] + std::size_t(std::lround(vector_field_->size[i] / vector_field_->spacing[i])) + 1, shape[i]);
+  }
+
+  auto derived_field = std::make_unique<scalar_field>();
+  derived_field->data.resize(boost::extents
+   [end[0] - begin[0]]
+   [end[1] - begin[1]]
+   [end[2] - begin[2]]);
+  derived_field->offset  = vector_field_->offset ;
+  derived_field->size    = vector_field_->size   ;
+  derived_field->spacing = vector_field_->spacing;
+
+  const auto tile_size = std::max<std::size_t>(tile_size_, 1);
+  tbb::parallel_for(tbb::blocked_range3d<std::size_t>(begin[0], end[0], tile_size, begin[1], end[1], tile_size, begin[2], end[2], row_size),
+    [&] (const tbb::blocked_range3d<std::size_t>& index) {
+    gradient_stencil stencil(vector_field_);
+    const auto z_begin = index.cols().begin(), z_end = index.cols().end(), count = z_end - z_begin;
+    for (auto x = index.pages().begin(), x_end = index.pages().end(); x < x_end; ++x) {
+    for (auto y = index.rows ().begin(), y_end = index.rows ().end(); y < y_end; ++y) {
+      stencil.compute(x, y, z_begin, z_end);
+
+      const auto& j      = stencil.jacobian;
+      const auto  target = &derived_field->data[x - begin[0]][y - begin[1]][z_begin - begin[2]];
+      if      (mode_ == mode::vorticity_magnitude)
+      {
+        for (std::size_t k = 0; k < count; ++k)
+        {
+          const auto curl_x = j[7][k] - j[5][k];
+          const auto curl_y = j[2][k] - j[6][k];
+          const auto curl_z = j[3][k] - j[1][k];
+          target[k] = std::sqrt(curl_x * curl_x + curl_y * curl_y + curl_z * curl_z);
+        }
+      }
+      else if (mode_ == mode::q_criterion)
+      {
+        // Equals -0.5 trace(J^2).
+        for (std::size_t k = 0; k < count; ++k)
+          target[k] = - scalar(0.5) * (j[0][k] * j[0][k] + j[4][k] * j[4][k] + j[8][k] * j[8][k])
+                      - (j[1][k] * j[3][k] + j[2][k] * j[6][k] + j[5][k] * j[7][k]);
+      }
+      else if (mode_ == mode::divergence)
+      {
+        for (std::size_t k = 0; k < count; ++k)
+          target[k] = j[0][k] + j[4][k] + j[8][k];
+      }
+    }}
+  }, tbb::simple_partitioner());
+
+  return derived_field;
+}
+}
\ No newline at end of file
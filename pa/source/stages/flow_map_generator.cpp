@@ -11,7 +11,7 @@ flow_map_generator::flow_map_generator(partitioner* partitioner) : particle_adve
 
 std::unique_ptr<vector_field> flow_map_generator::generate  (const std::size_t iterations      , const scalar resolution_scale)
 {
-  auto particles = std::vector     <particle>    ();
+  auto particles = particle_array                ();
   auto flow_map  = std::make_unique<vector_field>();
   if (partitioner_->communicator()->rank() == 0) std::cout << "2.1.0::flow_map_generator::allocate\n"  ; allocate  (resolution_scale,            flow_map);
   if (partitioner_->communicator()->rank() == 0) std::cout << "2.1.1::flow_map_generator::initialize\n"; initialize(iterations      , particles, flow_map);
@@ -36,18 +36,18 @@ void                          flow_map_generator::allocate  (const scalar      r
     base_spacing[1] / resolution_scale,
     base_spacing[2] / resolution_scale};
 }
-void                          flow_map_generator::initialize(const std::size_t iterations      ,       std::vector<particle>& particles, const std::unique_ptr<vector_field>& flow_map)
+void                          flow_map_generator::initialize(const std::size_t iterations      ,       particle_array&        particles, const std::unique_ptr<vector_field>& flow_map)
 {
   // Create particles centered at each voxel of the vector field.
   particles = seed_generator::generate(flow_map->offset, flow_map->size, flow_map->spacing, iterations, partitioner_->communicator()->rank());
 }
-void                          flow_map_generator::assign    (                                    const std::vector<particle>& particles,       std::unique_ptr<vector_field>& flow_map)
+void                          flow_map_generator::assign    (                                    const particle_array&        particles,       std::unique_ptr<vector_field>& flow_map)
 {
   // Assign final position of particles to their originating voxel.
   tbb::parallel_for(std::size_t(0), particles.size(), std::size_t(1), [&] (const std::size_t index)
   {
-    const auto& voxel = particles[index].original_voxel;
-    flow_map->data[voxel[0]][voxel[1]][voxel[2]] = particles[index].position.head<3>();
+    const auto& voxel = particles.original_voxel[index];
+    flow_map->data[voxel[0]][voxel[1]][voxel[2]] = vector3(particles.x[index], particles.y[index], particles.z[index]);
   });
 }
-}
+}
\ No newline at end of file
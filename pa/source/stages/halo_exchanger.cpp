@@ -0,0 +1,161 @@
+#include <pa/stages/halo_exchanger.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/mpi.hpp>
+#include <boost/multi_array.hpp>
+#include <tbb/tbb.h>
+
+#include <pa/math/types.hpp>
+
+#undef min
+#undef max
+
+namespace pa
+{
+halo_exchanger::halo_exchanger(partitioner* partitioner) : partitioner_(partitioner)
+{
+
+}
+
+void halo_exchanger::exchange(vector_field* vector_field)
+{
+  auto& local       = partitioner_->local_rank_info   ().value();
+  auto& neighbors   = partitioner_->neighbor_rank_info();
+  auto& block_size  = partitioner_->block_size        ();
+  auto  ghost_width = partitioner_->ghost_width       ();
+
+  if (ghost_width == 0)
+    return;
+  for (auto i = 0; i < 3; ++i)
+    if (partitioner_->grid_size()[i] > 1 && ghost_width >= block_size[i])
+      throw std::runtime_error("Ghost width must be smaller than the block size.");
+  if (vector_field->data_layout == vector_field::layout::sparse   || vector_field->data_layout == vector_field::layout::mapped ||
+      vector_field->data_layout == vector_field::layout::external || vector_field->data_layout == vector_field::layout::external_double)
+    throw std::runtime_error("Halo exchange requires a dense vector field layout.");
+
+  std::array<std::size_t, 3> lower, upper, loaded = vector_field->shape(), shape;
+  for (auto i = 0; i < 3; ++i)
+  {
+    lower[i] = std::size_t(local.lower_ghost_width[i]);
+    upper[i] = std::size_t(local.upper_ghost_width[i]);
+    shape[i] = lower[i] + loaded[i] + upper[i];
+  }
+
+  boost::multi_array<vector3, 3> data(shape);
+  const auto for_each = [&] (const std::array<std::size_t, 3>& extent, const auto& function)
+  {
+    tbb::parallel_for(tbb::blocked_range3d<std::size_t>(0, extent[0], 0, extent[1], 0, extent[2]), [&] (const tbb::blocked_range3d<std::size_t>& index) {
+      for (auto x = index.pages().begin(), x_end = index.pages().end(); x < x_end; ++x) {
+      for (auto y = index.rows ().begin(), y_end = index.rows ().end(); y < y_end; ++y) {
+      for (auto z = index.cols ().begin(), z_end = index.cols ().end(); z < z_end; ++z) {
+        function(x, y, z);
+      }}}
+    });
+  };
+  for_each(loaded, [&] (const std::size_t x, const std::size_t y, const std::size_t z)
+  {
+    data[lower[0] + x][lower[1] + y][lower[2] + z] = vector_field->at(x, y, z);
+  });
+
+  // Axes are exchanged in order, each across the full extent of the other axes.
+  for (auto axis = 0; axis < 3; ++axis)
+  {
+    // The lower neighbor already loaded the first owned layer as its positive ghost voxel, hence receives the layers after it.
+    const auto block = std::size_t(block_size[axis]);
+    const std::array<std::array<std::size_t, 2>, 2> send_ranges
+    {{
+      {lower[axis] + 1                  , lower[axis] + 1 + lower[axis]},
+      {lower[axis] + block - upper[axis], lower[axis] + block          }
+    }};
+    const std::array<std::array<std::size_t, 2>, 2> receive_ranges
+    {{
+      {0                                , lower[axis]                  },
+      {lower[axis] + loaded[axis]       , shape[axis]                  }
+    }};
+
+    const auto for_each_in_slab = [&] (const std::array<std::size_t, 2>& range, const auto& function)
+    {
+      auto first = std::array<std::size_t, 3> {0, 0, 0};
+      auto last  = shape;
+      first[axis] = range[0];
+      last [axis] = range[1];
+
+      std::size_t index = 0;
+      for (auto x = first[0]; x < last[0]; ++x)
+      for (auto y = first[1]; y < last[1]; ++y)
+      for (auto z = first[2]; z < last[2]; ++z)
+        function(data[x][y][z], index++);
+    };
+
+    std::array<std::vector<scalar>, 2> outgoing;
+    std::vector<boost::mpi::request>   requests;
+    for (auto side = 0; side < 2; ++side)
+    {
+      auto& neighbor = neighbors[2 * axis + side];
+      if (!neighbor)
+        continue;
+
+      for_each_in_slab(send_ranges[side], [&] (const vector3& value, const std::size_t)
+      {
+        outgoing[side].insert(outgoing[side].end(), value.data(), value.data() + 3);
+      });
+      requests.push_back(partitioner_->communicator()->isend(neighbor->rank, 20 + axis, outgoing[side]));
+    }
+    for (auto side = 0; side < 2; ++side)
+    {
+      auto& neighbor = neighbors[2 * axis + side];
+      if (!neighbor)
+        continue;
+
+      std::vector<scalar> incoming;
+      partitioner_->communicator()->recv(neighbor->rank, 20 + axis, incoming);
+      for_each_in_slab(receive_ranges[side], [&] (vector3& value, const std::size_t index)
+      {
+        value = Eigen::Map<const vector3>(incoming.data() + 3 * index);
+      });
+    }
+
+    for (auto& request : requests)
+      request.wait();
+  }
+
+  switch (vector_field->data_layout)
+  {
+  case vector_field::layout::bricked:
+    vector_field->bricked_data.resize(shape);
+    for_each(shape, [&] (const std::size_t x, const std::size_t y, const std::size_t z) { vector_field->bricked_data(x, y, z) = data[x][y][z]; });
+    break;
+  case vector_field::layout::bricked_half:
+    vector_field->half_data.resize(shape);
+    for_each(shape, [&] (const std::size_t x, const std::size_t y, const std::size_t z) { vector_field->half_data(x, y, z) = half_vector3::encode(data[x][y][z]); });
+    break;
+  case vector_field::layout::bricked_octahedral:
+  {
+    // The ghost layers may exceed the magnitude scale of the block, which is hence recomputed.
+    const auto maximum_magnitude = tbb::parallel_reduce(tbb::blocked_range<std::size_t>(0, data.num_elements()), scalar(0), [&] (const tbb::blocked_range<std::size_t>& range, scalar maximum)
+    {
+      for (auto i = range.begin(); i < range.end(); ++i)
+        maximum = std::max(maximum, data.data()[i].norm());
+      return maximum;
+    }, [ ] (const scalar lhs, const scalar rhs) { return std::max(lhs, rhs); });
+
+    vector_field->magnitude_scale = maximum_magnitude > scalar(0) ? maximum_magnitude : scalar(1);
+    vector_field->octahedral_data.resize(shape);
+    for_each(shape, [&] (const std::size_t x, const std::size_t y, const std::size_t z) { vector_field->octahedral_data(x, y, z) = octahedral_vector3::encode(data[x][y][z], vector_field->magnitude_scale); });
+    break;
+  }
+  default:
+    vector_field->data.resize(boost::extents[0][0][0]);
+    vector_field->data.resize(shape);
+    vector_field->data = data;
+  }
+
+  vector_field->lower_ghost_width = local.lower_ghost_width;
+  vector_field->compute_macro_grid();
+}
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include <pa/stages/in_situ_adapter.hpp>
+
+#include <stdexcept>
+
+namespace pa
+{
+in_situ_adapter::in_situ_adapter(partitioner* partitioner) : partitioner_(partitioner)
+{
+
+}
+
+void                          in_situ_adapter::set_domain             (const ivector3& domain_size, const vector3& spacing)
+{
+  // The views are read-only, hence ghost layers can not be exchanged into them.
+  partitioner_->set_ghost_width(0);
+  partitioner_->set_domain_size(domain_size);
+  spacing_ = spacing;
+  external_data_.reset();
+  double_data_  .reset();
+}
+std::pair<ivector3, ivector3> in_situ_adapter::local_region           () const
+{
+  auto& local = partitioner_->local_rank_info().value();
+  return {local.offset, local.ghosted_block_size};
+}
+
+void                          in_situ_adapter::set_vector_field       (const std::array<const float *, 3>& components, const std::array<std::ptrdiff_t, 3>& strides)
+{
+  const auto size = local_region().second;
+  layout_ = vector_field::layout::external;
+  external_data_.view({std::size_t(size[0]), std::size_t(size[1]), std::size_t(size[2])}, components, strides);
+  double_data_  .reset();
+}
+void                          in_situ_adapter::set_vector_field       (const std::array<const double*, 3>& components, const std::array<std::ptrdiff_t, 3>& strides)
+{
+  const auto size = local_region().second;
+  layout_ = vector_field::layout::external_double;
+  double_data_  .view({std::size_t(size[0]), std::size_t(size[1]), std::size_t(size[2])}, components, strides);
+  external_data_.reset();
+}
+bool                          in_situ_adapter::has_vector_field       () const
+{
+  return !external_data_.empty() || !double_data_.empty();
+}
+
+std::optional<vector_field>   in_situ_adapter::load_local_vector_field() const
+{
+  if (!has_vector_field())
+    throw std::runtime_error("In-situ adapter has no vector field.");
+
+  std::optional<vector_field> vector_field;
+  vector_field.emplace();
+  vector_field->data_layout   = layout_       ;
+  vector_field->external_data = external_data_;
+  vector_field->double_data   = double_data_  ;
+  vector_field->spacing       = spacing_      ;
+  vector_field->offset        = partitioner_->local_rank_info()->offset.cast<float>().array() * spacing_.array();
+  vector_field->size          = partitioner_->block_size     ()        .cast<float>().array() * spacing_.array();
+  vector_field->compute_macro_grid();
+  return vector_field;
+}
+vector3                       in_situ_adapter::load_spacing           () const
+{
+  return spacing_;
+}
+}
\ No newline at end of file
@@ -0,0 +1,232 @@
+#include <pa/stages/numa_scheduler.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace pa
+{
+namespace
+{
+// Parses a list such as "0-3,8,10-11", as found in /sys/devices/system/node.
+std::vector<int> parse_list(const std::string& list)
+{
+  std::vector<int>   values;
+  std::stringstream  stream(list);
+  std::string        range ;
+  while (std::getline(stream, range, ','))
+  {
+    if (range.empty() || range == "\n")
+      continue;
+    const auto separator = range.find('-');
+    const auto first     = std::stoi(range.substr(0, separator));
+    const auto last      = separator == std::string::npos ? first : std::stoi(range.substr(separator + 1));
+    for (auto value = first; value <= last; ++value)
+      values.push_back(value);
+  }
+  return values;
+}
+
+// Calls function(pointer, bytes) with the storage of the vector field, if it is owned by the vector field.
+template <typename function_type>
+void for_storage(vector_field& vector_field, const function_type& function)
+{
+  const auto bricked = [&] (auto& array)
+  {
+    if (!array.mapped())
+      function(reinterpret_cast<char*>(array.data()), array.num_elements() * sizeof(*array.data()));
+  };
+
+  switch (vector_field.data_layout)
+  {
+  case vector_field::layout::linear            : function(reinterpret_cast<char*>(vector_field.data.data()), vector_field.data.num_elements() * sizeof(vector3)); break;
+  case vector_field::layout::sparse            :
+  case vector_field::layout::bricked           : bricked(vector_field.bricked_data   ); break;
+  case vector_field::layout::bricked_half      : bricked(vector_field.half_data      ); break;
+  case vector_field::layout::bricked_octahedral: bricked(vector_field.octahedral_data); break;
+  default                                      : break;
+  }
+}
+
+#ifdef __linux__
+class pinning_observer : public tbb::task_scheduler_observer
+{
+public:
+  explicit pinning_observer(tbb::task_arena& arena, const std::vector<int>& processors) : tbb::task_scheduler_observer(arena)
+  {
+    CPU_ZERO(&processors_);
+    for (auto processor : processors)
+      CPU_SET(processor, &processors_);
+    sched_getaffinity(0, sizeof(cpu_set_t), &process_);
+    observe(true);
+  }
+ ~pinning_observer()
+  {
+    observe(false);
+  }
+
+  void on_scheduler_entry(bool) override
+  {
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &processors_);
+  }
+  void on_scheduler_exit (bool) override // Threads leaving the arena (e.g. the main thread) regain the affinity of the process.
+  {
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &process_   );
+  }
+
+protected:
+  cpu_set_t processors_;
+  cpu_set_t process_   ;
+};
+#endif
+}
+
+numa_scheduler::numa_scheduler(const std::size_t thread_count)
+{
+  std::vector<std::vector<int>> processors;
+#ifdef __linux__
+  // Nodes without processors this process may run on (e.g. of other ranks bound to another socket) are skipped.
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  std::ifstream online("/sys/devices/system/node/online");
+  if (online && sched_getaffinity(0, sizeof(cpu_set_t), &allowed) == 0)
+  {
+    std::string list;
+    std::getline(online, list);
+    for (auto node : parse_list(list))
+    {
+      std::ifstream cpulist("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+      std::getline(cpulist, list);
+
+      std::vector<int> node_processors;
+      for (auto processor : parse_list(list))
+        if (processor < CPU_SETSIZE && CPU_ISSET(processor, &allowed))
+          node_processors.push_back(processor);
+      if (node_processors.empty())
+        continue;
+
+      node_ids_  .push_back(node);
+      processors .push_back(std::move(node_processors));
+    }
+  }
+#endif
+
+  if (processors.size() < 2)
+  {
+    node_ids_.assign(1, 0);
+    arenas_  .push_back(std::make_unique<tbb::task_arena>(int(std::max<std::size_t>(thread_count, 1))));
+    return;
+  }
+
+  // The threads are shared among the nodes in proportion to their processors.
+  std::size_t processor_count = 0;
+  for (auto& node_processors : processors)
+    processor_count += node_processors.size();
+  for (auto& node_processors : processors)
+  {
+    const auto concurrency = std::max<std::size_t>(1, std::size_t(std::round(double(thread_count) * node_processors.size() / processor_count)));
+    arenas_.push_back(std::make_unique<tbb::task_arena>(int(concurrency), 0));
+#ifdef __linux__
+    observers_.push_back(std::make_unique<pinning_observer>(*arenas_.back(), node_processors));
+#endif
+  }
+}
+
+std::size_t numa_scheduler::node_count() const
+{
+  return arenas_.size();
+}
+
+void        numa_scheduler::place     (vector_field& vector_field)
+{
+#ifdef __linux__
+  if (arenas_.size() < 2)
+    return;
+
+  for_storage(vector_field, [&] (char* pointer, const std::size_t bytes)
+  {
+    // Only the whole pages within the storage are moved, as the pages at its ends may be shared with neighboring allocations.
+    // The pages are moved rather than bound, hence the memory policy of the range outlives neither the vector field nor its storage.
+    const auto page_size  = std::size_t(sysconf(_SC_PAGESIZE));
+    const auto first_page = (reinterpret_cast<std::uintptr_t>(pointer) + page_size - 1) / page_size;
+    const auto last_page  = (reinterpret_cast<std::uintptr_t>(pointer) + bytes        ) / page_size;
+    if (last_page <= first_page)
+      return;
+    const auto page_count = last_page - first_page;
+
+    for_each_node([&] (const std::size_t node)
+    {
+      const auto begin = first_page + page_count *  node      / arenas_.size();
+      const auto end   = first_page + page_count * (node + 1) / arenas_.size();
+
+      // In batches, which bounds the page lists.
+      constexpr std::size_t batch_size = 4096;
+      std::vector<void*> pages   ;
+      std::vector<int>   nodes   ;
+      std::vector<int>   statuses;
+      for (auto batch_begin = begin; batch_begin < end; batch_begin += batch_size)
+      {
+        const auto batch_end = std::min(batch_begin + batch_size, end);
+        pages   .resize(batch_end - batch_begin);
+        nodes   .assign(pages.size(), node_ids_[node]);
+        statuses.assign(pages.size(), 0);
+        for (auto page = batch_begin; page < batch_end; ++page)
+          pages[page - batch_begin] = reinterpret_cast<void*>(page * page_size);
+
+        // Best effort: pages which can not be moved (e.g. under a restrictive memory policy) remain where they are.
+        syscall(SYS_move_pages, 0, pages.size(), pages.data(), nodes.data(), statuses.data(), MPOL_MF_MOVE);
+      }
+    });
+  });
+#endif
+}
+std::size_t numa_scheduler::node      (const vector_field& vector_field, const vector4& position) const
+{
+  if (arenas_.size() < 2)
+    return 0;
+
+  const auto shape  = vector_field.shape();
+  const auto origin = vector_field.origin();
+  if (shape[0] == 0 || shape[1] == 0 || shape[2] == 0)
+    return 0;
+
+  std::array<std::size_t, 3> cell;
+  for (auto i = 0; i < 3; ++i)
+    cell[i] = std::size_t(std::clamp(std::floor((position[i] - origin[i]) / vector_field.spacing[i]), scalar(0), scalar(shape[i] - 1)));
+
+  // The index of the cell within the storage, or the slab along x if the storage is not owned.
+  auto index = cell[0];
+  auto count = shape[0];
+  const auto bricked = [&] (const auto& array)
+  {
+    if (array.mapped())
+      return;
+    index = array.index(cell[0], cell[1], cell[2]);
+    count = array.num_elements();
+  };
+  switch (vector_field.data_layout)
+  {
+  case vector_field::layout::linear            : index = (cell[0] * shape[1] + cell[1]) * shape[2] + cell[2]; count = vector_field.data.num_elements(); break;
+  case vector_field::layout::sparse            :
+  case vector_field::layout::bricked           : bricked(vector_field.bricked_data   ); break;
+  case vector_field::layout::bricked_half      : bricked(vector_field.half_data      ); break;
+  case vector_field::layout::bricked_octahedral: bricked(vector_field.octahedral_data); break;
+  default                                      : break;
+  }
+  return std::min(index * arenas_.size() / count, arenas_.size() - 1);
+}
+}
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include <pa/stages/out_of_core_tracer.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include <pa/math/index.hpp>
+
+#undef min
+#undef max
+
+namespace pa
+{
+out_of_core_tracer::out_of_core_tracer(partitioner* partitioner, data_io* data_io, particle_tracer* particle_tracer) : partitioner_(partitioner), data_io_(data_io), particle_tracer_(particle_tracer)
+{
+
+}
+
+void                          out_of_core_tracer::set_block_size     (const ivector3&    block_size     )
+{
+  block_size_      = block_size     ;
+}
+void                          out_of_core_tracer::set_cache_directory(const std::string& cache_directory)
+{
+  cache_directory_ = cache_directory;
+}
+void                          out_of_core_tracer::set_prefetch       (const bool         prefetch       )
+{
+  prefetch_        = prefetch       ;
+}
+
+std::vector<integral_curves>  out_of_core_tracer::trace              (particle_array        particles)
+{
+  auto& local_block_size = partitioner_->block_size();
+  clamped_block_size_ = block_size_.cwiseMax(1).cwiseMin(local_block_size);
+  block_counts_       = (local_block_size + clamped_block_size_ - ivector3::Ones()).array() / clamped_block_size_.array();
+  spacing_            = data_io_->load_spacing();
+  queues_ .assign(block_counts_.prod(), particle_array());
+  loads_  = 0;
+  traced_ = 0;
+
+  std::vector<integral_curves> integral_curves;
+  particle_tracer_->set_local_vector_field(&block_);
+
+  while (!particle_tracer_->check_completion(particles))
+  {
+    // Collects the particles leaving the local block.
+    particle_tracer::round_info outgoing;
+    for (auto& neighbor : partitioner_->neighbor_rank_info())
+      if (neighbor)
+        outgoing.out_of_bounds_particles.emplace(neighbor->rank);
+
+    for (std::size_t index = 0; index < particles.size(); ++index)
+      enqueue(particles.get(index), outgoing);
+
+    for (auto index = most_queued(); index;)
+      index = trace_block(*index, integral_curves, outgoing);
+    outgoing.out_of_bounds_particles.merge();
+
+    particle_tracer_->out_of_bounds_distribute(particles, outgoing);
+  }
+
+  block_.reset();
+  particle_tracer_->prune(integral_curves);
+  return integral_curves;
+}
+
+std::array<std::size_t, 2>    out_of_core_tracer::statistics         () const
+{
+  return {loads_, traced_};
+}
+
+std::optional<std::size_t>    out_of_core_tracer::trace_block        (const std::size_t index, std::vector<integral_curves>& integral_curves, particle_tracer::round_info& outgoing)
+{
+  const auto region = block_region(index);
+  block_ = next_block_.valid() ? next_block_.get() : data_io_->load_vector_field_block(region.first, region.second, cache_directory_); // The prefetched block is the one traced next.
+  loads_++;
+
+  auto particles = std::move(queues_[index]);
+  queues_[index].clear();
+  traced_ += particles.size();
+
+  // The block with the most queued particles is prefetched while this one is traced, disregarding the particles this one hands over to it.
+  const auto next = most_queued();
+  if (prefetch_ && next)
+  {
+    const auto next_region = block_region(*next);
+    next_block_ = data_io_->load_vector_field_block_async(next_region.first, next_region.second, cache_directory_);
+  }
+
+  auto round_info = particle_tracer_->compute_round_info(particles, integral_curves);
+  round_info.out_of_bounds_particles.emplace(-1); // The tracer files particles leaving through a face without a neighbor rank under -1.
+  particle_tracer_->allocate  (           integral_curves, round_info);
+  particle_tracer_->initialize(particles, integral_curves, round_info);
+  particle_tracer_->trace     (particles, integral_curves, round_info);
+
+  // Particles which remain within this block could not advance within it, i.e. reached its last cell at the border of the domain.
+  for (auto& entry : round_info.out_of_bounds_particles)
+    for (std::size_t particle_index = 0; particle_index < entry.second.size(); ++particle_index)
+      if (block_index(entry.second.position(particle_index)) != index)
+        enqueue(entry.second.get(particle_index), outgoing);
+
+  return next ? next : most_queued();
+}
+void                          out_of_core_tracer::enqueue            (const particle& particle, particle_tracer::round_info& outgoing)
+{
+  if (const auto index = block_index(particle.position))
+  {
+    queues_[*index].push_back(particle);
+    return;
+  }
+
+  // Leaves the local block, hence is handed over to the neighbor across the first face it crossed, or terminates at the border of the domain.
+  auto& local     = partitioner_->local_rank_info   ().value();
+  auto& neighbors = partitioner_->neighbor_rank_info();
+  const vector3 minimum = local.offset.cast<scalar>().array() * spacing_.array();
+  const vector3 maximum = minimum.array() + partitioner_->block_size().cast<scalar>().array() * spacing_.array();
+
+  auto neighbor_rank = -1;
+  if      (particle.position[0] < minimum[0] && neighbors[0]) neighbor_rank = neighbors[0]->rank;
+  else if (particle.position[0] > maximum[0] && neighbors[1]) neighbor_rank = neighbors[1]->rank;
+  else if (particle.position[1] < minimum[1] && neighbors[2]) neighbor_rank = neighbors[2]->rank;
+  else if (particle.position[1] > maximum[1] && neighbors[3]) neighbor_rank = neighbors[3]->rank;
+  else if (particle.position[2] < minimum[2] && neighbors[4]) neighbor_rank = neighbors[4]->rank;
+  else if (particle.position[2] > maximum[2] && neighbors[5]) neighbor_rank = neighbors[5]->rank;
+
+  outgoing.out_of_bounds_particles.push(neighbor_rank, particle);
+}
+std::optional<std::size_t>    out_of_core_tracer::block_index        (const vector4&  position) const
+{
+  auto& local            = partitioner_->local_rank_info().value();
+  auto& local_block_size = partitioner_->block_size     ();
+
+  // Matches vector_field::contains, i.e. a block contains the cells beginning within it.
+  ivector3 multi_index;
+  for (auto i = 0; i < 3; ++i)
+  {
+    const auto subscript = std::floor((position[i] - scalar(local.offset[i]) * spacing_[i]) / spacing_[i]);
+    if (!(subscript >= scalar(0) && subscript < scalar(local_block_size[i])))
+      return std::nullopt;
+    multi_index[i] = integer(subscript) / clamped_block_size_[i];
+  }
+  return ravel_multi_index(multi_index, block_counts_);
+}
+std::pair<ivector3, ivector3> out_of_core_tracer::block_region       (const std::size_t index   ) const
+{
+  const ivector3 multi_index = unravel_index(index, block_counts_);
+  const ivector3 offset      = multi_index.array() * clamped_block_size_.array();
+  const ivector3 size        = clamped_block_size_.cwiseMin(partitioner_->block_size() - offset);
+  return {partitioner_->local_rank_info()->offset + offset, size};
+}
+std::optional<std::size_t>    out_of_core_tracer::most_queued        () const
+{
+  const auto iterator = std::max_element(queues_.begin(), queues_.end(), [ ] (const particle_array& lhs, const particle_array& rhs) { return lhs.size() < rhs.size(); });
+  if (iterator == queues_.end() || iterator->empty())
+    return std::nullopt;
+  return std::size_t(std::distance(queues_.begin(), iterator));
+}
+}
\ No newline at end of file
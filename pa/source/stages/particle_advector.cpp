@@ -1,20 +1,20 @@
 #include <pa/stages/particle_advector.hpp>
 
 #include <algorithm>
-#include <mutex>
 
 #include <boost/serialization/vector.hpp>
 #include <boost/mpi.hpp>
 #include <tbb/tbb.h>
 
 #include <pa/math/integrators.hpp>
+#include <pa/math/packet_sampler.hpp>
 
 #undef min
 #undef max
 
 namespace pa
 {
-particle_advector::particle_advector(partitioner* partitioner) : partitioner_(partitioner)
+particle_advector::particle_advector(partitioner* partitioner) : partitioner_(partitioner), transport_(partitioner->communicator())
 {
 
 }
@@ -31,10 +31,14 @@ void                            particle_advector::set_step_size           (cons
 {               
   step_size_    = step_size    ;
 }
+void                            particle_advector::set_packet_mode         (const bool                packet_mode )
+{
+  packet_mode_  = packet_mode  ;
+}
 
-void                            particle_advector::advect                  (std::vector<particle>&    particles   )
+void                            particle_advector::advect                  (particle_array&           particles   )
 {
-  std::vector<std::vector<particle>> inactive_particles(partitioner_->communicator()->size());
+  std::vector<particle_array> inactive_particles(partitioner_->communicator()->size());
 
   while (!check_completion(particles))
   {
@@ -44,10 +48,7 @@ void                            particle_advector::advect                  (std:
   }
 
   if   (partitioner_->communicator()->rank() == 0) std::cout << "2.1.2.3::particle_advector::gather_particles\n";
-  std::vector<std::vector<particle>> gathered_particles(partitioner_->communicator()->size());
-  boost::mpi::all_to_all(*partitioner_->communicator(), inactive_particles, gathered_particles);
-  for (auto& particles_vector : gathered_particles)
-    particles.insert(particles.end(), particles_vector.begin(), particles_vector.end());
+  transport_.all_to_all(inactive_particles, particles);
 }
 
 particle_advector::particle_map particle_advector::create_neighborhood_map ()
@@ -55,56 +56,76 @@ particle_advector::particle_map particle_advector::create_neighborhood_map ()
   particle_map neighborhood_map;
   for (auto& neighbor : partitioner_->neighbor_rank_info())
     if (neighbor)
-      neighborhood_map.emplace(neighbor->rank, std::vector<particle>());
+      neighborhood_map.emplace(neighbor->rank);
   return neighborhood_map;
 }
-void                            particle_advector::advect                  (      std::vector<particle>& active_particles, std::vector<std::vector<particle>>& inactive_particles,       particle_map& neighborhood_map)
+void                            particle_advector::advect                  (      particle_array&        active_particles, std::vector<particle_array>&        inactive_particles,       particle_map& neighborhood_map)
 {
-  tbb::mutex mutex;
+  // Filed under their original rank by each thread, and appended to the inactive particles once all are advected.
+  particle_outbox inactive;
+  for (std::size_t rank = 0; rank < inactive_particles.size(); ++rank)
+    inactive.emplace(integer(rank));
+
+  if (packet_mode_ && is_single_step(integrator_))
+    advect_packets(active_particles, inactive, neighborhood_map);
+  else
+    advect_particles(active_particles, inactive, neighborhood_map);
 
+  neighborhood_map.merge();
+  inactive        .merge();
+  for (auto& entry : inactive)
+    inactive_particles[entry.first].append(entry.second);
+}
+void                            particle_advector::advect_particles        (      particle_array&        active_particles, particle_outbox&                    inactive_particles,       particle_map& neighborhood_map)
+{
   auto& neighbors = partitioner_->neighbor_rank_info();
 
   tbb::parallel_for(std::size_t(0), active_particles.size(), std::size_t(1), [&] (const std::size_t particle_index)
   {
-    auto& particle   = active_particles[particle_index];
+    auto  position   = active_particles.position(particle_index);
+    auto& remaining  = active_particles.remaining_iterations[particle_index];
     auto  minimum    = vector_field_->offset;
     auto  maximum    = vector_field_->offset + vector_field_->size;
     auto  integrator = integrator_;
+    auto  cache      = vector_field::sample_cache();
 
-    for (std::size_t iteration_index = 1; iteration_index < particle.remaining_iterations; ++iteration_index)
+    // The position is advanced in a local, and written back once the particle leaves this loop.
+    const auto file  = [&] (particle_outbox& outbox, const integer key)
     {
-      if (!vector_field_->contains(particle.position))
+      active_particles.set_position(particle_index, position);
+      outbox.push(key, active_particles.get(particle_index));
+    };
+
+    for (std::size_t iteration_index = 1; iteration_index < remaining; ++iteration_index)
+    {
+      if (!vector_field_->contains(position))
       {
-        particle.remaining_iterations -= iteration_index;
+        remaining -= iteration_index;
 
         auto neighbor_rank = -1;
-        if      (particle.position[0] < minimum[0] && neighbors[0]) neighbor_rank = neighbors[0]->rank;
-        else if (particle.position[0] > maximum[0] && neighbors[1]) neighbor_rank = neighbors[1]->rank;
-        else if (particle.position[1] < minimum[1] && neighbors[2]) neighbor_rank = neighbors[2]->rank;
-        else if (particle.position[1] > maximum[1] && neighbors[3]) neighbor_rank = neighbors[3]->rank;
-        else if (particle.position[2] < minimum[2] && neighbors[4]) neighbor_rank = neighbors[4]->rank;
-        else if (particle.position[2] > maximum[2] && neighbors[5]) neighbor_rank = neighbors[5]->rank;
+        if      (position[0] < minimum[0] && neighbors[0]) neighbor_rank = neighbors[0]->rank;
+        else if (position[0] > maximum[0] && neighbors[1]) neighbor_rank = neighbors[1]->rank;
+        else if (position[1] < minimum[1] && neighbors[2]) neighbor_rank = neighbors[2]->rank;
+        else if (position[1] > maximum[1] && neighbors[3]) neighbor_rank = neighbors[3]->rank;
+        else if (position[2] < minimum[2] && neighbors[4]) neighbor_rank = neighbors[4]->rank;
+        else if (position[2] > maximum[2] && neighbors[5]) neighbor_rank = neighbors[5]->rank;
         else
         {
-          tbb::mutex::scoped_lock lock(mutex);
-          particle.remaining_iterations = 0;
-          inactive_particles[particle.original_rank].push_back(particle);
+          remaining = 0;
+          file(inactive_particles, active_particles.original_rank[particle_index]);
           break;
         }
 
-        particle_map::accessor accessor;
-        if (neighborhood_map.find(accessor, neighbor_rank))
-          accessor->second.push_back(particle);
+        file(neighborhood_map, neighbor_rank);
 
         break;
       }
 
-      const auto vector = vector_field_->interpolate(particle.position);
+      const auto vector = vector_field_->empty(position) ? vector3(vector3::Zero()) : vector_field_->interpolate(position, cache);
       if (vector.isZero())
       {
-        tbb::mutex::scoped_lock lock(mutex);
-        particle.remaining_iterations = 0;
-        inactive_particles[particle.original_rank].push_back(particle);
+        remaining = 0;
+        file(inactive_particles, active_particles.original_rank[particle_index]);
         break;
       }
       
@@ -113,51 +134,124 @@ void                            particle_advector::advect                  (
         dxdt = vector4(vector[0], vector[1], vector[2], scalar(0));
       };
       if      (std::holds_alternative<euler_integrator>                       (integrator))
-        std::get<euler_integrator>                       (integrator).do_step(system, particle.position, iteration_index * step_size_, step_size_);
+        std::get<euler_integrator>                       (integrator).do_step(system, position, iteration_index * step_size_, step_size_);
       else if (std::holds_alternative<modified_midpoint_integrator>           (integrator))
-        std::get<modified_midpoint_integrator>           (integrator).do_step(system, particle.position, iteration_index * step_size_, step_size_);
+        std::get<modified_midpoint_integrator>           (integrator).do_step(system, position, iteration_index * step_size_, step_size_);
       else if (std::holds_alternative<runge_kutta_4_integrator>               (integrator))
-        std::get<runge_kutta_4_integrator>               (integrator).do_step(system, particle.position, iteration_index * step_size_, step_size_);
+        std::get<runge_kutta_4_integrator>               (integrator).do_step(system, position, iteration_index * step_size_, step_size_);
       else if (std::holds_alternative<runge_kutta_cash_karp_54_integrator>    (integrator))
-        std::get<runge_kutta_cash_karp_54_integrator>    (integrator).do_step(system, particle.position, iteration_index * step_size_, step_size_);
+        std::get<runge_kutta_cash_karp_54_integrator>    (integrator).do_step(system, position, iteration_index * step_size_, step_size_);
       else if (std::holds_alternative<runge_kutta_dormand_prince_5_integrator>(integrator))
-        std::get<runge_kutta_dormand_prince_5_integrator>(integrator).do_step(system, particle.position, iteration_index * step_size_, step_size_);
+        std::get<runge_kutta_dormand_prince_5_integrator>(integrator).do_step(system, position, iteration_index * step_size_, step_size_);
       else if (std::holds_alternative<runge_kutta_fehlberg_78_integrator>     (integrator))
-        std::get<runge_kutta_fehlberg_78_integrator>     (integrator).do_step(system, particle.position, iteration_index * step_size_, step_size_);
+        std::get<runge_kutta_fehlberg_78_integrator>     (integrator).do_step(system, position, iteration_index * step_size_, step_size_);
       else if (std::holds_alternative<adams_bashforth_2_integrator>           (integrator))
-        std::get<adams_bashforth_2_integrator>           (integrator).do_step(system, particle.position, iteration_index * step_size_, step_size_);
+        std::get<adams_bashforth_2_integrator>           (integrator).do_step(system, position, iteration_index * step_size_, step_size_);
       else if (std::holds_alternative<adams_bashforth_moulton_2_integrator>   (integrator))
-        std::get<adams_bashforth_moulton_2_integrator>   (integrator).do_step(system, particle.position, iteration_index * step_size_, step_size_);
+        std::get<adams_bashforth_moulton_2_integrator>   (integrator).do_step(system, position, iteration_index * step_size_, step_size_);
       
-      if (iteration_index + 1 == particle.remaining_iterations)
+      if (iteration_index + 1 == remaining)
       {
-        tbb::mutex::scoped_lock lock(mutex);
-        particle.remaining_iterations = 0;
-        inactive_particles[particle.original_rank].push_back(particle);
+        remaining = 0;
+        file(inactive_particles, active_particles.original_rank[particle_index]);
         break;
       }
     }
+
+    sample_cache_hits_   += cache.hits  ;
+    sample_cache_misses_ += cache.misses;
   });
 }
-void                            particle_advector::out_of_bounds_distribute(      std::vector<particle>& active_particles,                                                         const particle_map& neighborhood_map)
+void                            particle_advector::advect_packets          (      particle_array&        active_particles, particle_outbox&                    inactive_particles,       particle_map& neighborhood_map)
 {
-  active_particles.clear();
-
-  std::vector<boost::mpi::request> requests;
-  for (auto& neighbor : neighborhood_map)
-    requests.push_back(partitioner_->communicator()->isend(neighbor.first, 3, neighbor.second));
+  auto& neighbors = partitioner_->neighbor_rank_info();
+  auto  minimum   = vector_field_->offset;
+  auto  maximum   = vector_field_->offset + vector_field_->size;
 
-  for (auto& neighbor : neighborhood_map)
+  // Advances packet_size particles in SIMD lanes. Lanes are masked out as their particles terminate.
+  tbb::parallel_for(std::size_t(0), (active_particles.size() + packet_size - 1) / packet_size, std::size_t(1), [&] (const std::size_t packet_index)
   {
-    std::vector<particle> temporary;
-    partitioner_->communicator()->recv(neighbor.first, 3, temporary);
-    active_particles.insert(active_particles.end(), temporary.begin(), temporary.end());
-  }
+    const auto     begin     = packet_index * packet_size;
+    const auto     count     = std::min(packet_size, active_particles.size() - begin);
+
+    packet_sampler sampler   ;
+    packet_vector3 positions = packet_vector3::Zero();
+    packet_mask    active    = packet_mask::Constant(false);
+    for (std::size_t lane = 0; lane < count; ++lane)
+    {
+      sampler.set_vector_field(lane, vector_field_);
+      positions.row(lane) << active_particles.x[begin + lane], active_particles.y[begin + lane], active_particles.z[begin + lane];
+      active   [lane]     = active_particles.remaining_iterations[begin + lane] > 1;
+    }
+
+    const auto store      = [&] (const std::size_t lane)
+    {
+      active_particles.x[begin + lane] = positions(lane, 0);
+      active_particles.y[begin + lane] = positions(lane, 1);
+      active_particles.z[begin + lane] = positions(lane, 2);
+    };
+    const auto deactivate = [&] (const std::size_t lane)
+    {
+      store(lane);
+      active_particles.remaining_iterations[begin + lane] = 0;
+      inactive_particles.push(active_particles.original_rank[begin + lane], active_particles.get(begin + lane));
+      active[lane] = false;
+    };
+
+    for (std::size_t iteration_index = 1; active.any(); ++iteration_index)
+    {
+      const packet_mask inside = sampler.contains(positions);
+      for (std::size_t lane = 0; lane < count; ++lane)
+      {
+        if (!active[lane] || inside[lane])
+          continue;
+
+        store(lane);
+        active_particles.remaining_iterations[begin + lane] -= iteration_index;
 
-  for (auto& request : requests)
-    request.wait();
+        auto neighbor_rank = -1;
+        if      (positions(lane, 0) < minimum[0] && neighbors[0]) neighbor_rank = neighbors[0]->rank;
+        else if (positions(lane, 0) > maximum[0] && neighbors[1]) neighbor_rank = neighbors[1]->rank;
+        else if (positions(lane, 1) < minimum[1] && neighbors[2]) neighbor_rank = neighbors[2]->rank;
+        else if (positions(lane, 1) > maximum[1] && neighbors[3]) neighbor_rank = neighbors[3]->rank;
+        else if (positions(lane, 2) < minimum[2] && neighbors[4]) neighbor_rank = neighbors[4]->rank;
+        else if (positions(lane, 2) > maximum[2] && neighbors[5]) neighbor_rank = neighbors[5]->rank;
+        else
+        {
+          deactivate(lane);
+          continue;
+        }
+
+        neighborhood_map.push(neighbor_rank, active_particles.get(begin + lane));
+
+        active[lane] = false;
+      }
+
+      const packet_vector3 vectors = sampler.interpolate(positions, active && !sampler.empty(positions)); // Empty lanes sample zero.
+      const packet_mask    moving  = (vectors != scalar(0)).rowwise().any();
+      for (std::size_t lane = 0; lane < count; ++lane)
+        if (active[lane] && !moving[lane])
+          deactivate(lane);
+
+      positions = active.replicate<1, 3>().select(positions + vectors * step_size_, positions);
+      for (std::size_t lane = 0; lane < count; ++lane)
+        if (active[lane] && iteration_index + 1 == std::size_t(active_particles.remaining_iterations[begin + lane]))
+          deactivate(lane);
+    }
+
+    for (auto& cache : sampler.caches)
+    {
+      sample_cache_hits_   += cache.hits  ;
+      sample_cache_misses_ += cache.misses;
+    }
+  });
+}
+void                            particle_advector::out_of_bounds_distribute(      particle_array&        active_particles,                                                         const particle_map& neighborhood_map)
+{
+  active_particles.clear(); // Keeps the capacity for the received particles.
+  transport_.exchange(neighborhood_map, active_particles, 3);
 }
-bool                            particle_advector::check_completion        (const std::vector<particle>& active_particles)
+bool                            particle_advector::check_completion        (const particle_array&        active_particles)
 {
   std::vector<std::size_t> active_particle_counts;
   boost::mpi::gather   (*partitioner_->communicator(), active_particles.size(), active_particle_counts, 0);
@@ -165,4 +259,14 @@ bool                            particle_advector::check_completion        (cons
   boost::mpi::broadcast(*partitioner_->communicator(), complete, 0);
   return complete;
 }
+
+std::array<std::size_t, 2>      particle_advector::sample_cache_statistics      () const
+{
+  return {sample_cache_hits_.load(), sample_cache_misses_.load()};
+}
+void                            particle_advector::reset_sample_cache_statistics()
+{
+  sample_cache_hits_   = 0;
+  sample_cache_misses_ = 0;
 }
+}
\ No newline at end of file
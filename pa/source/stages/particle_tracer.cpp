@@ -1,6 +1,7 @@
 #include <pa/stages/particle_tracer.hpp>
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
 
 #include <boost/serialization/vector.hpp>
@@ -8,13 +9,14 @@
 #include <tbb/tbb.h>
 
 #include <pa/math/integrators.hpp>
+#include <pa/math/packet_sampler.hpp>
 
 #undef min
 #undef max
 
 namespace pa
 {
-particle_tracer::particle_tracer(partitioner* partitioner) : partitioner_(partitioner)
+particle_tracer::particle_tracer(partitioner* partitioner) : partitioner_(partitioner), transport_(partitioner->communicator())
 {
 
 }
@@ -23,9 +25,10 @@ void                         particle_tracer::set_local_vector_field    (std::op
 {
   local_vector_field_     = local_vector_field    ;
 }
-void                         particle_tracer::set_neighbor_vector_fields(std::array<std::optional<vector_field>, 6>* neighbor_vector_fields)
+void                         particle_tracer::set_neighbor_vector_fields(std::array<std::optional<vector_field>, 6>* neighbor_vector_fields, const std::array<std::shared_future<void>, 6>& loaded)
 {
-  neighbor_vector_fields_ = neighbor_vector_fields;
+  neighbor_vector_fields_        = neighbor_vector_fields;
+  neighbor_vector_fields_loaded_ = loaded;
 }
 void                         particle_tracer::set_integrator            (const variant_integrator&                   integrator            )
 {
@@ -35,8 +38,30 @@ void                         particle_tracer::set_step_size             (const s
 {
   step_size_     = step_size    ;
 }
+void                         particle_tracer::set_packet_mode           (const bool                                  packet_mode           )
+{
+  packet_mode_   = packet_mode  ;
+}
+void                         particle_tracer::set_unsteady_vector_field (const unsteady_vector_field*                unsteady_vector_field )
+{
+  unsteady_vector_field_ = unsteady_vector_field;
+}
+void                         particle_tracer::set_neighbor_depth        (const integer                               neighbor_depth        )
+{
+  neighbor_depth_ = neighbor_depth;
+}
+void                         particle_tracer::set_block_cache           (block_cache*                                block_cache           )
+{
+  block_cache_ = block_cache;
+  if (block_cache_)
+    neighbor_vector_fields_ = block_cache_->vector_fields();
+}
+void                         particle_tracer::set_numa_scheduler        (numa_scheduler*                             numa_scheduler        )
+{
+  numa_scheduler_ = numa_scheduler;
+}
 
-std::vector<integral_curves> particle_tracer::trace                     (std::vector<particle>                       particles             )
+std::vector<integral_curves> particle_tracer::trace                     (particle_array                              particles             )
 {
   std::vector<integral_curves> integral_curves;
 
@@ -55,7 +80,7 @@ std::vector<integral_curves> particle_tracer::trace                     (std::ve
   return integral_curves;
 }
 
-void                         particle_tracer::load_balance_distribute   (      std::vector<particle>& particles                                                                                   )
+void                         particle_tracer::load_balance_distribute   (      particle_array&        particles                                                                                   )
 {
   // Send/receive particle counts.
   auto neighbors                = partitioner_->neighbor_rank_info();
@@ -165,7 +190,7 @@ void                         particle_tracer::load_balance_distribute   (      s
   }
   
   // Compute surplus particles.
-  auto surplus_particles = std::array<std::vector<particle>, 6> {};
+  auto surplus_particles = std::array<particle_array, 6> {};
   for (auto i = 0; i < neighbors.size(); ++i)
   {
     if (!neighbors[i] || neighbor_particle_counts[i] > average)
@@ -176,42 +201,39 @@ void                         particle_tracer::load_balance_distribute   (      s
     if (particle_count > particles.size())
       continue;
 
-    surplus_particles[i].insert(surplus_particles[i].end(), particles.end() - particle_count, particles.end());
-    particles.erase(particles.end() - particle_count, particles.end());
+    auto first = particles.size() - particle_count;
+    if (neighbor_depth_ > 0) // The neighbor only holds the slab of this block along the shared face.
+      first = std::max(first, particles.partition([&] (const std::size_t index) { return !within_neighbor_slab(i, particles.position(index)); }));
 
-    tbb::parallel_for(std::size_t(0), surplus_particles[i].size(), std::size_t(1), [&](const std::size_t index)
-    {
-      surplus_particles[i][index].vector_field_index = i % 2 == 0 ? i + 1 : i - 1; // This process' +X neighbor treats this process as its -X neighbor and so on. 
-    });
+    surplus_particles[i].append(particles, first, particles.size());
+    particles.resize(first);
+
+    auto& vector_field_index = surplus_particles[i].vector_field_index;
+    std::fill(vector_field_index.begin(), vector_field_index.end(), i % 2 == 0 ? i + 1 : i - 1); // This process' +X neighbor treats this process as its -X neighbor and so on. 
   }
 
   // Send/receive particles.
-  requests.clear();
+  std::vector<particle_transport::entry> outgoing;
+  std::vector<std::size_t>               faces   ;
   for (auto i = 0; i < neighbors.size(); ++i)
   {
     if (!neighbors[i])
       continue;
 
-    requests.push_back(partitioner_->communicator()->isend(neighbors[i]->rank, 1, surplus_particles[i]));
-  }
-  for (auto i = 0; i < neighbors.size(); ++i)
-  {
-    if (!neighbors[i]) 
-      continue;
-
-    std::vector<particle> temporary;
-    partitioner_->communicator()->recv (neighbors[i]->rank, 1, temporary);
-    particles.insert(particles.end(), temporary.begin(), temporary.end());
+    outgoing.emplace_back(neighbors[i]->rank, &surplus_particles[i]);
+    faces   .push_back   (i);
   }
 
-  for (auto& request : requests)
-    request.wait();
+  const auto received = transport_.exchange(outgoing, particles, 1);
+  for (std::size_t i = 0; i < faces.size(); ++i)
+    if (received[i] > 0) // Received particles are traced in the vector field of this neighbor.
+      require_neighbor_vector_field(faces[i]);
 }
-particle_tracer::round_info  particle_tracer::compute_round_info        (const std::vector<particle>& particles, const std::vector<integral_curves>& integral_curves                              )
+particle_tracer::round_info  particle_tracer::compute_round_info        (const particle_array&        particles, const std::vector<integral_curves>& integral_curves                              )
 {
   round_info round_info;
 
-  round_info.maximum_remaining_iterations        = std::max_element(particles.begin(), particles.end(), [ ] (const particle& lhs, const particle& rhs) { return lhs.remaining_iterations < rhs.remaining_iterations; })->remaining_iterations;
+  round_info.maximum_remaining_iterations        = *std::max_element(particles.remaining_iterations.begin(), particles.remaining_iterations.end());
  
   const auto maximum_vertices_per_integral_curve = std::numeric_limits<integer>::max() / sizeof(vector4);
   const auto particles_per_integral_curve        = maximum_vertices_per_integral_curve / round_info.maximum_remaining_iterations;
@@ -225,8 +247,8 @@ particle_tracer::round_info  particle_tracer::compute_round_info        (const s
   {
     if (neighbor)
     {
-      round_info.out_of_bounds_particles         .emplace(neighbor->rank, std::vector<particle>());
-      round_info.neighbor_out_of_bounds_particles.emplace(neighbor->rank, std::vector<particle>());
+      round_info.out_of_bounds_particles         .emplace(neighbor->rank);
+      round_info.neighbor_out_of_bounds_particles.emplace(neighbor->rank);
     }
   }
 
@@ -240,30 +262,40 @@ void                         particle_tracer::allocate                  (
     integral_curves[index].vertices.resize(index != integral_curves.size() - 1 ? round_info.vertices_per_integral_curve : round_info.vertices_per_integral_curve_last, invalid_vertex);
   });
 }
-void                         particle_tracer::initialize                (const std::vector<particle>& particles,       std::vector<integral_curves>& integral_curves, const round_info& round_info)
+void                         particle_tracer::initialize                (const particle_array&        particles,       std::vector<integral_curves>& integral_curves, const round_info& round_info)
 {
   tbb::parallel_for(std::size_t(0), particles.size(), std::size_t(1), [&] (const std::size_t index)
   {
     const auto absolute_vertex_index = index * round_info.maximum_remaining_iterations;
     const auto relative_vertex_index = absolute_vertex_index % round_info.vertices_per_integral_curve;
     const auto integral_curve_index  = absolute_vertex_index / round_info.vertices_per_integral_curve + round_info.integral_curve_offset;
-    integral_curves[integral_curve_index].vertices[relative_vertex_index] = particles[index].position;
+    integral_curves[integral_curve_index].vertices[relative_vertex_index] = particles.position(index);
   });
 }
-void                         particle_tracer::trace                     (const std::vector<particle>& particles,       std::vector<integral_curves>& integral_curves,       round_info& round_info)
+void                         particle_tracer::trace                     (const particle_array&        particles,       std::vector<integral_curves>& integral_curves,       round_info& round_info)
 {
+  if (packet_mode_ && is_single_step(integrator_) && !unsteady_vector_field_)
+  {
+    trace_packets(particles, integral_curves, round_info);
+    return;
+  }
+
   auto& local     = partitioner_->local_rank_info   ();
   auto& neighbors = partitioner_->neighbor_rank_info();
 
-  tbb::parallel_for(std::size_t(0), particles.size(), std::size_t(1), [&] (const std::size_t particle_index)
+  const auto trace_particle = [&] (const std::size_t particle_index)
   {
-    auto& particle      = particles[particle_index];
-    auto& vector_field  = particle.vector_field_index == -1 ? local_vector_field_->value() : neighbor_vector_fields_->at(particle.vector_field_index).value();
-    auto  minimum       = vector_field.offset;
-    auto  maximum       = vector_field.offset + vector_field.size;
-    auto  integrator    = integrator_;
-
-    for (std::size_t iteration_index = 1; iteration_index < particle.remaining_iterations; ++iteration_index)
+    auto  remaining      = particles.remaining_iterations[particle_index];
+    auto  field_index    = particles.vector_field_index  [particle_index];
+    auto  unsteady       = unsteady_vector_field_ && field_index == -1; // Neighbor vector fields are steady.
+    auto& vector_field   = unsteady ? *unsteady_vector_field_->start : field_index == -1 ? local_vector_field_->value() : neighbor_vector_fields_->at(field_index).value();
+    auto  minimum        = vector_field.offset;
+    auto  maximum        = vector_field.offset + vector_field.size;
+    auto  integrator     = integrator_;
+    auto  cache          = vector_field::sample_cache();
+    auto  unsteady_cache = unsteady_vector_field::sample_cache();
+
+    for (std::size_t iteration_index = 1; iteration_index < remaining; ++iteration_index)
     {
       const auto  absolute_vertex_index = particle_index * round_info.maximum_remaining_iterations + iteration_index;
       const auto  relative_vertex_index = absolute_vertex_index % round_info.vertices_per_integral_curve;
@@ -274,14 +306,14 @@ void                         particle_tracer::trace                     (const s
       
       vertex = termination_vertex;
 
-      if (iteration_index == particle.remaining_iterations - 1)
+      if (iteration_index == remaining - 1)
         break;
 
       if (!vector_field.contains(last_vertex))
       {
-        pa::particle neighbor_particle {last_vertex, particle.remaining_iterations - iteration_index, -1};
+        pa::particle neighbor_particle {last_vertex, remaining - iteration_index, -1};
 
-        if (particle.vector_field_index == -1)
+        if (field_index == -1)
         {
           auto neighbor_rank = -1;
           
@@ -292,29 +324,34 @@ void                         particle_tracer::trace                     (const s
           else if (neighbor_particle.position[2] < minimum[2] && neighbors[4]) neighbor_rank = neighbors[4]->rank;
           else if (neighbor_particle.position[2] > maximum[2] && neighbors[5]) neighbor_rank = neighbors[5]->rank;
           
-          round_info::particle_map::accessor accessor;
-          if (round_info.out_of_bounds_particles.find(accessor, neighbor_rank))
-            accessor->second.push_back(neighbor_particle);
+          round_info.out_of_bounds_particles.push(neighbor_rank, neighbor_particle);
         }
         else
         {
-          auto neighbor_rank = neighbors[particle.vector_field_index]->rank;
+          auto neighbor_rank = neighbors[field_index]->rank;
 
-          round_info::particle_map::accessor accessor;
-          if (round_info.neighbor_out_of_bounds_particles.find(accessor, neighbor_rank))
-            accessor->second.push_back(neighbor_particle);
+          round_info.neighbor_out_of_bounds_particles.push(neighbor_rank, neighbor_particle);
         }
 
         break;
       }
 
-      const auto vector = vector_field.interpolate(last_vertex);
+      if (unsteady && unsteady_vector_field_->expired(last_vertex))
+      {
+        round_info.expired_particles.push_back(pa::particle {last_vertex, integer(remaining - iteration_index), -1});
+        break;
+      }
+
+      if (unsteady ? unsteady_vector_field_->empty(last_vertex) : vector_field.empty(last_vertex))
+        break;
+
+      const auto vector = unsteady ? unsteady_vector_field_->interpolate(last_vertex, unsteady_cache) : vector_field.interpolate(last_vertex, cache);
       if (vector.isZero())
         break;
 
       const auto system = [&] (const vector4& x, vector4& dxdt, const float t) 
       { 
-        dxdt = vector4(vector[0], vector[1], vector[2], scalar(0));
+        dxdt = vector4(vector[0], vector[1], vector[2], unsteady ? scalar(1) : scalar(0)); // Time advances with the integration in unsteady fields.
       };
       if      (std::holds_alternative<euler_integrator>                       (integrator))
         std::get<euler_integrator>                       (integrator).do_step(system, last_vertex, iteration_index * step_size_, vertex, step_size_);
@@ -333,65 +370,228 @@ void                         particle_tracer::trace                     (const s
       else if (std::holds_alternative<adams_bashforth_moulton_2_integrator>   (integrator))
         std::get<adams_bashforth_moulton_2_integrator>   (integrator).do_step(system, last_vertex, iteration_index * step_size_, vertex, step_size_);
     }
-  });
+
+    sample_cache_hits_   += cache.hits   + unsteady_cache[0].hits   + unsteady_cache[1].hits  ;
+    sample_cache_misses_ += cache.misses + unsteady_cache[0].misses + unsteady_cache[1].misses;
+  };
+
+  if (numa_scheduler_ && numa_scheduler_->node_count() > 1)
+  {
+    const auto partition = partition_by_node(particles);
+    numa_scheduler_->for_each_node([&] (const std::size_t node)
+    {
+      tbb::parallel_for(std::size_t(0), partition[node].size(), std::size_t(1), [&] (const std::size_t index)
+      {
+        trace_particle(partition[node][index]);
+      });
+    });
+  }
+  else
+    tbb::parallel_for(std::size_t(0), particles.size(), std::size_t(1), trace_particle);
+
+  round_info.out_of_bounds_particles         .merge();
+  round_info.neighbor_out_of_bounds_particles.merge();
 }
-void                         particle_tracer::load_balance_collect      (                                                                                                   round_info& round_info)
+void                         particle_tracer::trace_packets             (const particle_array&        particles,       std::vector<integral_curves>& integral_curves,       round_info& round_info)
 {
   auto& neighbors = partitioner_->neighbor_rank_info();
-  auto  minimum   = local_vector_field_->value().offset;
-  auto  maximum   = local_vector_field_->value().offset + local_vector_field_->value().size;
-
-  std::vector<boost::mpi::request> requests;
-  for (auto& neighbor : round_info.neighbor_out_of_bounds_particles)
-    requests.push_back(partitioner_->communicator()->isend(neighbor.first, 2, neighbor.second));
 
-  for (auto& neighbor : round_info.neighbor_out_of_bounds_particles)
+  // Advances packet_size particles (of the given indices) in SIMD lanes. Lanes are masked out as their particles terminate.
+  const auto trace_packet = [&] (const std::array<std::size_t, packet_size>& indices, const std::size_t count)
   {
-    std::vector<particle> temporary;
-    partitioner_->communicator()->recv (neighbor.first, 2, temporary);
+    packet_sampler sampler   ;
+    packet_vector3 positions = packet_vector3::Zero();
+    packet_mask    active    = packet_mask::Constant(false);
+    for (std::size_t lane = 0; lane < count; ++lane)
+    {
+      const auto index = indices[lane];
+      sampler.set_vector_field(lane, particles.vector_field_index[index] == -1 ? &local_vector_field_->value() : &neighbor_vector_fields_->at(particles.vector_field_index[index]).value());
+      positions.row(lane) << particles.x[index], particles.y[index], particles.z[index];
+      active   [lane]     = true;
+    }
 
-    tbb::parallel_for(std::size_t(0), temporary.size(), std::size_t(1), [&] (const std::size_t index)
+    for (std::size_t iteration_index = 1; active.any(); ++iteration_index)
     {
-      auto& particle      = temporary[index];
-      auto  neighbor_rank = -1;
+      std::array<vector4*, packet_size> vertices {};
+      for (std::size_t lane = 0; lane < count; ++lane)
+      {
+        const auto remaining = std::size_t(particles.remaining_iterations[indices[lane]]);
+        if (!active[lane] || iteration_index >= remaining)
+        {
+          active[lane] = false;
+          continue;
+        }
+
+        const auto absolute_vertex_index = indices[lane] * round_info.maximum_remaining_iterations + iteration_index;
+        const auto relative_vertex_index = absolute_vertex_index % round_info.vertices_per_integral_curve;
+        const auto integral_curve_index  = absolute_vertex_index / round_info.vertices_per_integral_curve + round_info.integral_curve_offset;
+
+        vertices[lane]  = &integral_curves[integral_curve_index].vertices[relative_vertex_index];
+        *vertices[lane] = termination_vertex;
 
-      particle.vector_field_index = -1;
+        if (iteration_index == remaining - 1)
+          active[lane] = false;
+      }
+
+      const packet_mask inside = sampler.contains(positions);
+      for (std::size_t lane = 0; lane < count; ++lane)
+      {
+        if (!active[lane] || inside[lane])
+          continue;
 
-      if      (particle.position[0] < minimum[0] && neighbors[0]) neighbor_rank = neighbors[0]->rank;
-      else if (particle.position[0] > maximum[0] && neighbors[1]) neighbor_rank = neighbors[1]->rank;
-      else if (particle.position[1] < minimum[1] && neighbors[2]) neighbor_rank = neighbors[2]->rank;
-      else if (particle.position[1] > maximum[1] && neighbors[3]) neighbor_rank = neighbors[3]->rank;
-      else if (particle.position[2] < minimum[2] && neighbors[4]) neighbor_rank = neighbors[4]->rank;
-      else if (particle.position[2] > maximum[2] && neighbors[5]) neighbor_rank = neighbors[5]->rank;
+        const auto   index    = indices[lane];
+        pa::particle neighbor_particle {vector4(positions(lane, 0), positions(lane, 1), positions(lane, 2), particles.t[index]), integer(particles.remaining_iterations[index] - iteration_index), -1};
 
-      round_info::particle_map::accessor accessor;
-      if (round_info.out_of_bounds_particles.find(accessor, neighbor_rank))
-        accessor->second.push_back(particle);
+        auto                      neighbor_rank = -1;
+        round_info::particle_map* map           = &round_info.out_of_bounds_particles;
+        if (particles.vector_field_index[index] == -1)
+        {
+          const auto& minimum = sampler.vector_fields[lane]->offset;
+          const auto  maximum = sampler.vector_fields[lane]->offset + sampler.vector_fields[lane]->size;
+
+          if      (neighbor_particle.position[0] < minimum[0] && neighbors[0]) neighbor_rank = neighbors[0]->rank;
+          else if (neighbor_particle.position[0] > maximum[0] && neighbors[1]) neighbor_rank = neighbors[1]->rank;
+          else if (neighbor_particle.position[1] < minimum[1] && neighbors[2]) neighbor_rank = neighbors[2]->rank;
+          else if (neighbor_particle.position[1] > maximum[1] && neighbors[3]) neighbor_rank = neighbors[3]->rank;
+          else if (neighbor_particle.position[2] < minimum[2] && neighbors[4]) neighbor_rank = neighbors[4]->rank;
+          else if (neighbor_particle.position[2] > maximum[2] && neighbors[5]) neighbor_rank = neighbors[5]->rank;
+        }
+        else
+        {
+          neighbor_rank = neighbors[particles.vector_field_index[index]]->rank;
+          map           = &round_info.neighbor_out_of_bounds_particles;
+        }
+
+        map->push(neighbor_rank, neighbor_particle);
+
+        active[lane] = false;
+      }
+
+      active = active && !sampler.empty(positions);
+
+      const packet_vector3 vectors = sampler.interpolate(positions, active);
+      active = active && (vectors != scalar(0)).rowwise().any();
+
+      positions = active.replicate<1, 3>().select(positions + vectors * step_size_, positions);
+      for (std::size_t lane = 0; lane < count; ++lane)
+        if (active[lane])
+          *vertices[lane] = vector4(positions(lane, 0), positions(lane, 1), positions(lane, 2), particles.t[indices[lane]]);
+    }
+
+    for (auto& cache : sampler.caches)
+    {
+      sample_cache_hits_   += cache.hits  ;
+      sample_cache_misses_ += cache.misses;
+    }
+  };
+
+  if (numa_scheduler_ && numa_scheduler_->node_count() > 1)
+  {
+    const auto partition = partition_by_node(particles);
+    numa_scheduler_->for_each_node([&] (const std::size_t node)
+    {
+      auto& indices = partition[node];
+      tbb::parallel_for(std::size_t(0), (indices.size() + packet_size - 1) / packet_size, std::size_t(1), [&] (const std::size_t packet_index)
+      {
+        const auto begin = packet_index * packet_size;
+        const auto count = std::min(packet_size, indices.size() - begin);
+
+        std::array<std::size_t, packet_size> packet {};
+        std::copy_n(indices.begin() + begin, count, packet.begin());
+        trace_packet(packet, count);
+      });
     });
   }
+  else
+  {
+    tbb::parallel_for(std::size_t(0), (particles.size() + packet_size - 1) / packet_size, std::size_t(1), [&] (const std::size_t packet_index)
+    {
+      const auto begin = packet_index * packet_size;
+      const auto count = std::min(packet_size, particles.size() - begin);
 
-  for (auto& request : requests)
-    request.wait();
+      std::array<std::size_t, packet_size> packet {};
+      for (std::size_t lane = 0; lane < count; ++lane)
+        packet[lane] = begin + lane;
+      trace_packet(packet, count);
+    });
+  }
+
+  round_info.out_of_bounds_particles         .merge();
+  round_info.neighbor_out_of_bounds_particles.merge();
 }
-void                         particle_tracer::out_of_bounds_distribute  (      std::vector<particle>& particles,                                                      const round_info& round_info)
+void                         particle_tracer::require_neighbor_vector_field(const std::size_t index)
 {
-  particles.clear();
-
-  std::vector<boost::mpi::request> requests;
-  for (auto& neighbor : round_info.out_of_bounds_particles)
-    requests.push_back(partitioner_->communicator()->isend(neighbor.first, 3, neighbor.second));
+  auto& loaded = neighbor_vector_fields_loaded_[index];
+  if (loaded.valid())
+  {
+    loaded.get();
+    loaded = std::shared_future<void>();
+  }
 
-  for (auto& neighbor : round_info.out_of_bounds_particles)
+  if (block_cache_)
+    block_cache_->acquire(index);
+}
+bool                         particle_tracer::within_neighbor_slab      (const std::size_t index, const vector4& position) const
+{
+  const auto& vector_field = local_vector_field_->value();
+  const auto  axis         = index / 2;
+  const auto  subscript    = std::floor((position[axis] - vector_field.offset[axis]) / vector_field.spacing[axis]);
+  return index % 2 == 0 ? subscript < scalar(neighbor_depth_) : subscript >= scalar(partitioner_->block_size()[axis] - neighbor_depth_);
+}
+std::vector<std::vector<std::size_t>> particle_tracer::partition_by_node(const particle_array&        particles) const
+{
+  std::vector<std::vector<std::size_t>> partition(numa_scheduler_->node_count());
+  for (std::size_t index = 0; index < particles.size(); ++index)
   {
-    std::vector<particle> temporary;
-    partitioner_->communicator()->recv (neighbor.first, 3, temporary);
-    particles.insert(particles.end(), temporary.begin(), temporary.end());
+    auto  field_index  = particles.vector_field_index[index];
+    auto& vector_field = unsteady_vector_field_ && field_index == -1 ? *unsteady_vector_field_->start : field_index == -1 ? local_vector_field_->value() : neighbor_vector_fields_->at(field_index).value();
+    partition[numa_scheduler_->node(vector_field, particles.position(index))].push_back(index);
   }
+  return partition;
+}
+void                         particle_tracer::load_balance_collect      (                                                                                                   round_info& round_info)
+{
+  auto& neighbors = partitioner_->neighbor_rank_info();
+  auto  minimum   = local_vector_field_->value().offset;
+  auto  maximum   = local_vector_field_->value().offset + local_vector_field_->value().size;
 
-  for (auto& request : requests)
-    request.wait();
+  particle_array returned;
+  transport_.exchange(round_info.neighbor_out_of_bounds_particles, returned, 2);
+
+  tbb::parallel_for(std::size_t(0), returned.size(), std::size_t(1), [&] (const std::size_t index)
+  {
+    returned.vector_field_index[index] = -1;
+
+    auto particle = returned.get(index);
+    auto face     = -1;
+
+    if      (particle.position[0] < minimum[0]) face = 0;
+    else if (particle.position[0] > maximum[0]) face = 1;
+    else if (particle.position[1] < minimum[1]) face = 2;
+    else if (particle.position[1] > maximum[1]) face = 3;
+    else if (particle.position[2] < minimum[2]) face = 4;
+    else if (particle.position[2] > maximum[2]) face = 5;
+
+    if (face == -1) // Left the slab of the neighbor through its inner face, hence still within the local block.
+      round_info.returned_particles.push_back(particle);
+    else if (neighbors[face])
+      round_info.out_of_bounds_particles.push(neighbors[face]->rank, particle);
+    // Otherwise the particle left the domain.
+  });
+  round_info.out_of_bounds_particles.merge();
+
+  if (block_cache_) // The neighbor vector fields are no longer in use until the next round.
+    block_cache_->release();
+}
+void                         particle_tracer::out_of_bounds_distribute  (      particle_array&        particles,                                                      const round_info& round_info)
+{
+  particles.clear(); // Keeps the capacity for the received particles.
+  transport_.exchange(round_info.out_of_bounds_particles, particles, 3);
+
+  for (auto& particle : round_info.returned_particles)
+    particles.push_back(particle);
 }
-bool                         particle_tracer::check_completion          (const std::vector<particle>& particles                                                                                   )
+bool                         particle_tracer::check_completion          (const particle_array&        particles                                                                                   )
 {
   std::vector<std::size_t> particle_sizes;
   boost::mpi::gather   (*partitioner_->communicator(), particles.size(), particle_sizes, 0);
@@ -407,4 +607,14 @@ void                         particle_tracer::prune                     (
     vertices.erase(std::remove(vertices.begin(), vertices.end(), invalid_vertex), vertices.end());
   });
 }
+
+std::array<std::size_t, 2>   particle_tracer::sample_cache_statistics   () const
+{
+  return {sample_cache_hits_.load(), sample_cache_misses_.load()};
+}
+void                         particle_tracer::reset_sample_cache_statistics()
+{
+  sample_cache_hits_   = 0;
+  sample_cache_misses_ = 0;
+}
 }
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include <pa/stages/particle_transport.hpp>
+
+#include <array>
+#include <numeric>
+#include <stdexcept>
+
+namespace pa
+{
+namespace
+{
+constexpr int count_tag = 30;
+}
+
+particle_transport::particle_transport(boost::mpi::communicator* communicator) : communicator_(communicator)
+{
+
+}
+particle_transport::~particle_transport()
+{
+  int finalized = 0;
+  MPI_Finalized(&finalized);
+  if (finalized)
+    return;
+
+  unbind();
+}
+
+std::vector<std::size_t> particle_transport::exchange  (const std::vector<entry>& outgoing, particle_array& incoming, const int tag)
+{
+  std::vector<integer> ranks;
+  for (auto& neighbor : outgoing)
+    ranks.push_back(neighbor.first);
+  if (ranks != ranks_)
+    bind(ranks);
+
+  // Counts.
+  const auto size = ranks_.size();
+  for (std::size_t i = 0; i < size; ++i)
+    send_counts_[i] = outgoing[i].second->size();
+  MPI_Startall(int(size), count_requests_.data()       );
+  MPI_Startall(int(size), count_requests_.data() + size);
+  MPI_Waitall (int(2 * size), count_requests_.data(), MPI_STATUSES_IGNORE);
+
+  // Particles. Empty messages are skipped, as both sides know the counts. The columns are resized before any datatype takes their addresses.
+  std::vector<std::size_t> received(size);
+  auto offset = incoming.size();
+  incoming.resize(offset + std::accumulate(receive_counts_.begin(), receive_counts_.end(), std::size_t(0)));
+
+  requests_ .clear();
+  datatypes_.clear();
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    received[i] = std::size_t(receive_counts_[i]);
+    if (received[i] > 0)
+    {
+      requests_ .emplace_back();
+      datatypes_.push_back   (datatype(incoming, offset, received[i]));
+      MPI_Irecv(MPI_BOTTOM, 1, datatypes_.back(), ranks_[i], tag, MPI_Comm(*communicator_), &requests_.back());
+    }
+    offset += received[i];
+  }
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    if (outgoing[i].second->empty())
+      continue;
+    requests_ .emplace_back();
+    datatypes_.push_back   (datatype(*outgoing[i].second, 0, outgoing[i].second->size()));
+    MPI_Isend(MPI_BOTTOM, 1, datatypes_.back(), ranks_[i], tag, MPI_Comm(*communicator_), &requests_.back());
+  }
+  MPI_Waitall(int(requests_.size()), requests_.data(), MPI_STATUSES_IGNORE);
+
+  for (auto& type : datatypes_)
+    MPI_Type_free(&type);
+  datatypes_.clear();
+
+  return received;
+}
+void                     particle_transport::all_to_all(const std::vector<particle_array>& outgoing, particle_array& incoming)
+{
+  const auto size = std::size_t(communicator_->size());
+  if (outgoing.size() != size)
+    throw std::runtime_error("Particle transport requires one array per rank.");
+
+  std::vector<int> send_counts(size), receive_counts(size);
+  for (std::size_t rank = 0; rank < size; ++rank)
+    send_counts[rank] = int(outgoing[rank].size());
+  MPI_Alltoall(send_counts.data(), 1, MPI_INT, receive_counts.data(), 1, MPI_INT, MPI_Comm(*communicator_));
+
+  auto offset = incoming.size();
+  incoming.resize(offset + std::accumulate(receive_counts.begin(), receive_counts.end(), std::size_t(0)));
+
+  // One message of one datatype per non-empty pair of ranks, at absolute addresses, hence without staging on either side.
+  std::vector<int>          send_types_counts(size, 0), receive_types_counts(size, 0), displacements(size, 0);
+  std::vector<MPI_Datatype> send_types       (size, MPI_BYTE), receive_types(size, MPI_BYTE);
+  for (std::size_t rank = 0; rank < size; ++rank)
+  {
+    if (send_counts[rank] > 0)
+    {
+      send_types       [rank] = datatype(outgoing[rank], 0, std::size_t(send_counts[rank]));
+      send_types_counts[rank] = 1;
+    }
+    if (receive_counts[rank] > 0)
+    {
+      receive_types       [rank] = datatype(incoming, offset, std::size_t(receive_counts[rank]));
+      receive_types_counts[rank] = 1;
+    }
+    offset += std::size_t(receive_counts[rank]);
+  }
+
+  MPI_Alltoallw(MPI_BOTTOM, send_types_counts.data(), displacements.data(), send_types.data(), MPI_BOTTOM, receive_types_counts.data(), displacements.data(), receive_types.data(), MPI_Comm(*communicator_));
+
+  for (std::size_t rank = 0; rank < size; ++rank)
+  {
+    if (send_types_counts   [rank] > 0) MPI_Type_free(&send_types   [rank]);
+    if (receive_types_counts[rank] > 0) MPI_Type_free(&receive_types[rank]);
+  }
+}
+
+MPI_Datatype             particle_transport::datatype  (const particle_array& particles, const std::size_t begin, const std::size_t count)
+{
+  static_assert(sizeof(ivector3) == 3 * sizeof(integer), "The original voxels must be contiguous integers.");
+
+  const auto length = int(count);
+  std::array<int         , 8> lengths {length, length, length, length, length, length, length, 3 * length};
+  std::array<MPI_Datatype, 8> types   {MPI_FLOAT, MPI_FLOAT, MPI_FLOAT, MPI_FLOAT, MPI_INT32_T, MPI_INT32_T, MPI_INT32_T, MPI_INT32_T};
+  std::array<MPI_Aint    , 8> displacements;
+  MPI_Get_address(particles.x                   .data() + begin, &displacements[0]);
+  MPI_Get_address(particles.y                   .data() + begin, &displacements[1]);
+  MPI_Get_address(particles.z                   .data() + begin, &displacements[2]);
+  MPI_Get_address(particles.t                   .data() + begin, &displacements[3]);
+  MPI_Get_address(particles.remaining_iterations.data() + begin, &displacements[4]);
+  MPI_Get_address(particles.vector_field_index  .data() + begin, &displacements[5]);
+  MPI_Get_address(particles.original_rank       .data() + begin, &displacements[6]);
+  MPI_Get_address(particles.original_voxel[begin].data()       , &displacements[7]);
+
+  MPI_Datatype type;
+  MPI_Type_create_struct(int(lengths.size()), lengths.data(), displacements.data(), types.data(), &type);
+  MPI_Type_commit       (&type);
+  return type;
+}
+
+void                     particle_transport::bind      (const std::vector<integer>& ranks)
+{
+  unbind();
+
+  ranks_ = ranks;
+  send_counts_   .assign(ranks_.size(), 0);
+  receive_counts_.assign(ranks_.size(), 0);
+  count_requests_.assign(2 * ranks_.size(), MPI_REQUEST_NULL);
+  for (std::size_t i = 0; i < ranks_.size(); ++i)
+  {
+    MPI_Recv_init(&receive_counts_[i], 1, MPI_UNSIGNED_LONG_LONG, ranks_[i], count_tag, MPI_Comm(*communicator_), &count_requests_[i]                );
+    MPI_Send_init(&send_counts_   [i], 1, MPI_UNSIGNED_LONG_LONG, ranks_[i], count_tag, MPI_Comm(*communicator_), &count_requests_[ranks_.size() + i]);
+  }
+}
+void                     particle_transport::unbind    ()
+{
+  for (auto& request : count_requests_)
+    if (request != MPI_REQUEST_NULL)
+      MPI_Request_free(&request);
+  count_requests_.clear();
+  ranks_         .clear();
+}
+}
\ No newline at end of file
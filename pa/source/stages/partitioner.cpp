@@ -5,15 +5,24 @@
 
 namespace pa
 {
-partitioner::rank_info::rank_info(const integer rank, const ivector3& grid_size, const ivector3& block_size) 
+partitioner::rank_info::rank_info(const integer rank, const ivector3& grid_size, const ivector3& block_size, const integer ghost_width) 
 : rank              (rank)
 , multi_rank        (unravel_index(rank, grid_size))
 , offset            (block_size.array() * multi_rank.array())
 , ghosted_block_size(block_size)
+, lower_ghost_width (ivector3::Zero())
+, upper_ghost_width (ivector3::Zero())
 {
   for (auto i = 2; i >= 0; --i)
+  {
     if (multi_rank[i] + 1 < grid_size[i]) // If not at border in axis.
+    {
       ghosted_block_size[i]++;            // Add one voxel ghost region (note: positive XYZ only).
+      upper_ghost_width [i] = ghost_width;
+    }
+    if (multi_rank[i] > 0)
+      lower_ghost_width [i] = ghost_width;
+  }
 }
 
 partitioner::partitioner(boost::mpi::communicator* communicator): communicator_(communicator)
@@ -42,14 +51,18 @@ void                                                        partitioner::set_dom
 
   block_size_ = domain_size_.array() / grid_size_.array();
 
-  local_rank_info_.emplace(communicator_->rank(), grid_size_, block_size_);
+  local_rank_info_.emplace(communicator_->rank(), grid_size_, block_size_, ghost_width_);
   neighbor_rank_info_ = std::array<std::optional<rank_info>, 6>();
-  if (local_rank_info_->multi_rank[0] - 1 >= 0           ) neighbor_rank_info_[0].emplace(ravel_multi_index<ivector3>(local_rank_info_->multi_rank.array() + ivector3(-1,  0,  0).array(), grid_size_), grid_size_, block_size_);
-  if (local_rank_info_->multi_rank[0] + 1 < grid_size_[0]) neighbor_rank_info_[1].emplace(ravel_multi_index<ivector3>(local_rank_info_->multi_rank.array() + ivector3( 1,  0,  0).array(), grid_size_), grid_size_, block_size_);
-  if (local_rank_info_->multi_rank[1] - 1 >= 0           ) neighbor_rank_info_[2].emplace(ravel_multi_index<ivector3>(local_rank_info_->multi_rank.array() + ivector3( 0, -1,  0).array(), grid_size_), grid_size_, block_size_);
-  if (local_rank_info_->multi_rank[1] + 1 < grid_size_[1]) neighbor_rank_info_[3].emplace(ravel_multi_index<ivector3>(local_rank_info_->multi_rank.array() + ivector3( 0,  1,  0).array(), grid_size_), grid_size_, block_size_);
-  if (local_rank_info_->multi_rank[2] - 1 >= 0           ) neighbor_rank_info_[4].emplace(ravel_multi_index<ivector3>(local_rank_info_->multi_rank.array() + ivector3( 0,  0, -1).array(), grid_size_), grid_size_, block_size_);
-  if (local_rank_info_->multi_rank[2] + 1 < grid_size_[2]) neighbor_rank_info_[5].emplace(ravel_multi_index<ivector3>(local_rank_info_->multi_rank.array() + ivector3( 0,  0,  1).array(), grid_size_), grid_size_, block_size_);
+  if (local_rank_info_->multi_rank[0] - 1 >= 0           ) neighbor_rank_info_[0].emplace(ravel_multi_index<ivector3>(local_rank_info_->multi_rank.array() + ivector3(-1,  0,  0).array(), grid_size_), grid_size_, block_size_, ghost_width_);
+  if (local_rank_info_->multi_rank[0] + 1 < grid_size_[0]) neighbor_rank_info_[1].emplace(ravel_multi_index<ivector3>(local_rank_info_->multi_rank.array() + ivector3( 1,  0,  0).array(), grid_size_), grid_size_, block_size_, ghost_width_);
+  if (local_rank_info_->multi_rank[1] - 1 >= 0           ) neighbor_rank_info_[2].emplace(ravel_multi_index<ivector3>(local_rank_info_->multi_rank.array() + ivector3( 0, -1,  0).array(), grid_size_), grid_size_, block_size_, ghost_width_);
+  if (local_rank_info_->multi_rank[1] + 1 < grid_size_[1]) neighbor_rank_info_[3].emplace(ravel_multi_index<ivector3>(local_rank_info_->multi_rank.array() + ivector3( 0,  1,  0).array(), grid_size_), grid_size_, block_size_, ghost_width_);
+  if (local_rank_info_->multi_rank[2] - 1 >= 0           ) neighbor_rank_info_[4].emplace(ravel_multi_index<ivector3>(local_rank_info_->multi_rank.array() + ivector3( 0,  0, -1).array(), grid_size_), grid_size_, block_size_, ghost_width_);
+  if (local_rank_info_->multi_rank[2] + 1 < grid_size_[2]) neighbor_rank_info_[5].emplace(ravel_multi_index<ivector3>(local_rank_info_->multi_rank.array() + ivector3( 0,  0,  1).array(), grid_size_), grid_size_, block_size_, ghost_width_);
+}
+void                                                        partitioner::set_ghost_width   (const integer   ghost_width)
+{
+  ghost_width_ = ghost_width;
 }
 
 boost::mpi::communicator*                                   partitioner::communicator      ()
@@ -68,6 +81,10 @@ const ivector3&                                             partitioner::block_s
 {
   return block_size_;
 }
+integer                                                     partitioner::ghost_width       () const
+{
+  return ghost_width_;
+}
 
 const std::optional<partitioner::rank_info>&                partitioner::local_rank_info   () const
 {
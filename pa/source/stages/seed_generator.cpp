@@ -6,17 +6,22 @@
 
 namespace pa
 {
-std::vector<particle> seed_generator::generate(const vector3& offset, const vector3& size, const vector3& stride, integer remaining_iterations, integer rank)
+particle_array seed_generator::generate(const vector3& offset, const vector3& size, const vector3& stride, integer remaining_iterations, integer rank, const vector_field* vector_field)
 {
   ivector3 particles_per_dimension = (size.array() / stride.array()).cast<integer>();
 
-  std::vector<particle> particles(particles_per_dimension.prod());
+  particle_array particles;
+  particles.resize(particles_per_dimension.prod());
   tbb::parallel_for(std::size_t(0), particles.size(), std::size_t(1), [&] (const std::size_t index)
   {
     ivector3 multi_index = unravel_index(index, particles_per_dimension);
     vector3  position    = offset.array() + stride.array() * multi_index.cast<scalar>().array();
-    particles[index]     = particle {vector4(position[0], position[1], position[2], 0), remaining_iterations, -1, rank, multi_index};
+    particles.set(index, particle {vector4(position[0], position[1], position[2], 0), remaining_iterations, -1, rank, multi_index});
   });
+
+  if (vector_field)
+    particles.remove_if([&] (const std::size_t index) { return vector_field->empty(particles.position(index)); });
+
   return particles;
 }
 }
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include <pa/stages/time_slice_streamer.hpp>
+
+namespace pa
+{
+time_slice_streamer::time_slice_streamer(data_io* data_io) : data_io_(data_io)
+{
+
+}
+
+void                         time_slice_streamer::set_prefetch    (const bool prefetch)
+{
+  prefetch_ = prefetch;
+}
+
+bool                         time_slice_streamer::load            (const std::size_t time_slice)
+{
+  if (pending_.valid())
+    pending_.get();
+
+  time_slice_count_ = data_io_->load_time_slice_count();
+  if (time_slice + 1 >= time_slice_count_)
+    return false;
+  time_spacing_     = data_io_->load_time_spacing();
+  time_slice_       = time_slice;
+  start_slot_       = 0;
+
+  for (auto& slot : slots_)
+    slot.reset();
+  slots_[0] = data_io_->load_local_vector_field(time_slice    );
+  slots_[1] = data_io_->load_local_vector_field(time_slice + 1);
+  update_interval();
+  prefetch       ();
+  return true;
+}
+bool                         time_slice_streamer::advance         ()
+{
+  if (time_slice_ + 2 >= time_slice_count_)
+    return false;
+
+  const auto slot = (start_slot_ + 2) % slots_.size();
+  slots_[slot].reset();
+  slots_[slot] = pending_.valid() ? pending_.get() : data_io_->load_local_vector_field(time_slice_ + 2);
+
+  slots_[start_slot_].reset();
+  start_slot_ = (start_slot_ + 1) % slots_.size();
+  time_slice_++;
+  update_interval();
+  prefetch       ();
+  return true;
+}
+
+std::size_t                  time_slice_streamer::time_slice_count() const
+{
+  return time_slice_count_;
+}
+std::size_t                  time_slice_streamer::time_slice      () const
+{
+  return time_slice_;
+}
+const unsteady_vector_field& time_slice_streamer::interval        () const
+{
+  return interval_;
+}
+
+void                         time_slice_streamer::prefetch        ()
+{
+  if (!prefetch_ || time_slice_ + 2 >= time_slice_count_)
+    return;
+
+  if (!data_io_->can_load_async())
+    return;
+
+  // The load is pending in data_io, hence any other load (e.g. of a derived volume) or change of the file waits for it.
+  pending_ = data_io_->load_local_vector_field_async(time_slice_ + 2);
+}
+void                         time_slice_streamer::update_interval ()
+{
+  interval_.start      = &slots_[ start_slot_                      ].value();
+  interval_.end        = &slots_[(start_slot_ + 1) % slots_.size()].value();
+  interval_.start_time = scalar(time_slice_    ) * time_spacing_;
+  interval_.end_time   = scalar(time_slice_ + 1) * time_spacing_;
+}
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "catch/catch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+
+#include <pa/math/gradient_stencil.hpp>
+#include <pa/math/vector_field.hpp>
+#include <pa/stages/derived_field_generator.hpp>
+
+namespace
+{
+const std::array<std::size_t, 3> shape   {6, 5, 7};
+const pa::vector3                spacing {0.5f, 1.0f, 2.0f};
+
+// A row-major vector field without ghost layers, sampling the function at the voxel positions.
+pa::vector_field make_vector_field(const std::function<pa::vector3(const pa::vector3&)>& function)
+{
+  pa::vector_field vector_field;
+  vector_field.data.resize(boost::extents[shape[0]][shape[1]][shape[2]]);
+  vector_field.spacing = spacing;
+  vector_field.offset  = pa::vector3::Zero();
+  vector_field.size    = pa::vector3(spacing[0] * (shape[0] - 1), spacing[1] * (shape[1] - 1), spacing[2] * (shape[2] - 1));
+  for (std::size_t x = 0; x < shape[0]; ++x)
+  for (std::size_t y = 0; y < shape[1]; ++y)
+  for (std::size_t z = 0; z < shape[2]; ++z)
+    vector_field.data[x][y][z] = function(pa::vector3(x * spacing[0], y * spacing[1], z * spacing[2]));
+  return vector_field;
+}
+
+// The derivative of position^2 along an axis: central (lower + upper) within the bounds and one-sided at them.
+pa::scalar square_derivative(const std::size_t index, const std::size_t axis)
+{
+  const auto lower = index > 0               ? index - 1 : index;
+  const auto upper = index + 1 < shape[axis] ? index + 1 : index;
+  return pa::scalar(lower + upper) * spacing[axis];
+}
+}
+
+TEST_CASE("Gradient stencil is exact for a linear field.", "[gradient_stencil]")
+{
+  pa::matrix3 jacobian;
+  jacobian << 1.0f, -2.0f,  3.0f,
+              0.5f,  4.0f, -1.0f,
+             -3.0f,  2.0f,  0.25f;
+  auto vector_field = make_vector_field([&] (const pa::vector3& position) { return pa::vector3(jacobian * position + pa::vector3(1.0f, 2.0f, 3.0f)); });
+
+  pa::gradient_stencil stencil(&vector_field);
+  for (std::size_t x = 0; x < shape[0]; ++x)
+  for (std::size_t y = 0; y < shape[1]; ++y)
+  {
+    stencil.compute(x, y, 0, shape[2]);
+    for (std::size_t z = 0; z < shape[2]; ++z)
+    for (std::size_t i = 0; i < 3; ++i)
+    for (std::size_t j = 0; j < 3; ++j)
+      REQUIRE(stencil.jacobian[3 * i + j][z] == Approx(jacobian(i, j)).margin(1e-4));
+  }
+
+  const auto tensor_field = vector_field.gradient();
+  for (std::size_t x = 0; x < shape[0]; ++x)
+  for (std::size_t y = 0; y < shape[1]; ++y)
+  for (std::size_t z = 0; z < shape[2]; ++z)
+  for (std::size_t i = 0; i < 3; ++i)
+  for (std::size_t j = 0; j < 3; ++j)
+    REQUIRE(tensor_field->data[x][y][z](i, j) == Approx(jacobian(i, j)).margin(1e-4));
+}
+
+TEST_CASE("Gradient stencil is one-sided at the bounds and central within them.", "[gradient_stencil]")
+{
+  auto vector_field = make_vector_field([ ] (const pa::vector3& position) { return pa::vector3(position.cwiseProduct(position)); });
+
+  pa::gradient_stencil stencil(&vector_field);
+  for (std::size_t x = 0; x < shape[0]; ++x)
+  for (std::size_t y = 0; y < shape[1]; ++y)
+  {
+    // The whole row, and a part of it whose neighbors along z are stored.
+    for (auto range : {std::array<std::size_t, 2> {0, shape[2]}, std::array<std::size_t, 2> {2, 5}})
+    {
+      stencil.compute(x, y, range[0], range[1]);
+      for (auto z = range[0]; z < range[1]; ++z)
+      {
+        const std::array<std::size_t, 3> index {x, y, z};
+        for (std::size_t i = 0; i < 3; ++i)
+        for (std::size_t j = 0; j < 3; ++j)
+          REQUIRE(stencil.jacobian[3 * i + j][z - range[0]] == Approx(i == j ? square_derivative(index[i], i) : 0.0f).margin(1e-4));
+      }
+    }
+  }
+
+  const auto tensor_field = vector_field.gradient();
+  for (std::size_t x = 0; x < shape[0]; ++x)
+  for (std::size_t y = 0; y < shape[1]; ++y)
+  for (std::size_t z = 0; z < shape[2]; ++z)
+  {
+    const std::array<std::size_t, 3> index {x, y, z};
+    for (std::size_t i = 0; i < 3; ++i)
+      REQUIRE(tensor_field->data[x][y][z](i, i) == Approx(square_derivative(index[i], i)).margin(1e-4));
+  }
+}
+
+TEST_CASE("Derived field generator computes the vorticity, Q-criterion and divergence of a known flow.", "[derived_field_generator]")
+{
+  // A rotation about z with angular velocity w, superposed with a stretching (a, b, c).
+  const pa::scalar w = 1.5f, a = 0.5f, b = -2.0f, c = 0.25f;
+  auto vector_field = make_vector_field([&] (const pa::vector3& position)
+  {
+    return pa::vector3(a * position[0] - w * position[1], w * position[0] + b * position[1], c * position[2]);
+  });
+
+  const auto expect = [&] (const pa::derived_field_generator::mode mode, const pa::scalar expected)
+  {
+    pa::derived_field_generator generator(mode, 2); // Tiles smaller than the block.
+    generator.set_vector_field(&vector_field);
+    const auto derived_field = generator.generate();
+
+    REQUIRE(derived_field->data.shape()[0] == shape[0]);
+    REQUIRE(derived_field->data.shape()[1] == shape[1]);
+    REQUIRE(derived_field->data.shape()[2] == shape[2]);
+    REQUIRE(std::all_of(derived_field->data.data(), derived_field->data.data() + derived_field->data.num_elements(), [&] (const pa::scalar value)
+    {
+      return value == Approx(expected).margin(1e-4);
+    }));
+  };
+
+  expect(pa::derived_field_generator::mode::vorticity_magnitude, 2.0f * w);
+  expect(pa::derived_field_generator::mode::q_criterion        , w * w - 0.5f * (a * a + b * b + c * c));
+  expect(pa::derived_field_generator::mode::divergence         , a + b + c);
+}
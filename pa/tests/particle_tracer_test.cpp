@@ -0,0 +1,69 @@
+#include "catch/catch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <vector>
+
+#include <boost/mpi.hpp>
+
+#include <pa/math/particle_array.hpp>
+#include <pa/math/vector_field.hpp>
+#include <pa/stages/particle_tracer.hpp>
+#include <pa/stages/partitioner.hpp>
+
+TEST_CASE("Particles leaving a neighbor slab through its inner face keep tracing locally.", "[particle_tracer]")
+{
+  boost::mpi::environment  environment ;
+  boost::mpi::communicator communicator;
+  REQUIRE(communicator.size() == 1);
+
+  pa::partitioner partitioner(&communicator);
+  partitioner.set_domain_size(pa::ivector3(16, 16, 16));
+  const auto& local = partitioner.local_rank_info().value();
+
+  // A uniform flow along +x.
+  std::optional<pa::vector_field> vector_field;
+  vector_field.emplace();
+  vector_field->data.resize(boost::extents[local.ghosted_block_size[0]][local.ghosted_block_size[1]][local.ghosted_block_size[2]]);
+  std::fill(vector_field->data.data(), vector_field->data.data() + vector_field->data.num_elements(), pa::vector3(1.0f, 0.0f, 0.0f));
+  vector_field->spacing = pa::vector3(1.0f, 1.0f, 1.0f);
+  vector_field->offset  = local.offset.cast<pa::scalar>();
+  vector_field->size    = partitioner.block_size().cast<pa::scalar>();
+
+  std::array<std::optional<pa::vector_field>, 6> neighbor_vector_fields;
+
+  pa::particle_tracer particle_tracer(&partitioner);
+  particle_tracer.set_local_vector_field    (&vector_field);
+  particle_tracer.set_neighbor_vector_fields(&neighbor_vector_fields);
+  particle_tracer.set_integrator            (pa::euler_integrator());
+  particle_tracer.set_step_size             (1.0f);
+  particle_tracer.set_neighbor_depth        (2);
+
+  // The -X neighbor traced the particle in its slab of this block (the first two planes) until it left the slab along +x, and hands it back.
+  // This rank stands in for the neighbor, as the only rank.
+  const pa::vector4 position(2.5f, 8.0f, 8.0f, 0.0f);
+  pa::particle_tracer::round_info round_info {};
+  round_info.neighbor_out_of_bounds_particles.emplace(communicator.rank());
+  round_info.neighbor_out_of_bounds_particles.push   (communicator.rank(), pa::particle {position, 8, 0});
+  round_info.neighbor_out_of_bounds_particles.merge  ();
+
+  pa::particle_array particles;
+  particle_tracer.load_balance_collect    (           round_info);
+  particle_tracer.out_of_bounds_distribute(particles, round_info);
+
+  REQUIRE(particles.size() == 1);
+  REQUIRE(particles.vector_field_index  [0] == -1);
+  REQUIRE(particles.remaining_iterations[0] ==  8);
+  REQUIRE(particles.position(0).isApprox(position));
+
+  // It keeps going through the local block.
+  auto integral_curves = particle_tracer.trace(particles);
+  REQUIRE(integral_curves.size() == 1);
+
+  auto& vertices = integral_curves[0].vertices;
+  vertices.erase(std::remove(vertices.begin(), vertices.end(), pa::termination_vertex), vertices.end());
+  REQUIRE(vertices.size() > 1);
+  REQUIRE(vertices.front().isApprox(position));
+  REQUIRE(vertices.back ()[0] > position[0] + 1.0f);
+}
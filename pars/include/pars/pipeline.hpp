@@ -3,17 +3,30 @@
 
 #define BM_MPI_SUPPORT
 
+#include <array>
+#include <future>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include <bm/bm.hpp>
 #include <boost/mpi/cartesian_communicator.hpp>
 #include <boost/mpi.hpp>
 #include <pa/math/integral_curves.hpp>
+#include <pa/math/particle_array.hpp>
 #include <pa/math/scalar_field.hpp>
 #include <pa/math/vector_field.hpp>
 #include <pa/stages/partitioner.hpp>
+#include <pa/stages/block_cache.hpp>
+#include <pa/stages/block_sharer.hpp>
 #include <pa/stages/data_io.hpp>
+#include <pa/stages/derived_field_generator.hpp>
+#include <pa/stages/halo_exchanger.hpp>
+#include <pa/stages/in_situ_adapter.hpp>
+#include <pa/stages/numa_scheduler.hpp>
+#include <pa/stages/out_of_core_tracer.hpp>
 #include <pa/stages/particle_tracer.hpp>
+#include <pa/stages/time_slice_streamer.hpp>
 #include <tbb/tbb.h>
 
 #include <pars/stages/ray_tracer.hpp>
@@ -27,19 +40,30 @@ namespace pars
 class PARS_EXPORT pipeline
 {
 public:
+  using counter_list = std::vector<std::pair<std::string, std::size_t>>;
+
   explicit pipeline  (const std::size_t thread_count = tbb::task_scheduler_init::default_num_threads());
   pipeline           (const pipeline&   that) = default;
   pipeline           (      pipeline&&  temp) = default;
- ~pipeline           ()                       = default;
+ ~pipeline           ();
   pipeline& operator=(const pipeline&   that) = default;
   pipeline& operator=(      pipeline&&  temp) = default;
 
-  std::pair<image, bm::mpi_session<>> execute     (const settings& settings);
-                   bm::mpi_session<>  execute_ftle(const settings& settings);
+  std::pair<image, bm::mpi_session<>> execute         (const settings& settings);
+  // Traces and renders the vector field set on the in-situ adapter in place of the dataset. Unsteady, load balanced, out-of-core and node shared tracing
+  // as well as volume rendering read the dataset, hence are disabled, except for volumes derived from the vector field (volume_derived_field).
+  // The memory of the simulation is viewed anew on each execution.
+  std::pair<image, bm::mpi_session<>> execute_in_situ (const settings& settings);
+                   bm::mpi_session<>  execute_ftle    (const settings& settings);
   
-  boost::mpi::communicator*           communicator();
+  boost::mpi::communicator*           communicator    ();
+  pa::in_situ_adapter*                in_situ_adapter ();
+  // The counters (e.g. cache hits and misses) of this rank in the last iteration of the last execution. Kept apart from the session, which holds timings.
+  const counter_list&                 counters        () const;
 
 protected:
+  std::pair<image, bm::mpi_session<>> execute         (const settings& settings, bool in_situ);
+
   boost::mpi::environment                        environment_           ;
   boost::mpi::communicator                       communicator_          ;
                                                                         
@@ -47,16 +71,26 @@ protected:
                                                                         
   pa::partitioner                                partitioner_           ;
   pa::data_io                                    data_io_               ;
+  pa::in_situ_adapter                            in_situ_adapter_       ;
+  pa::halo_exchanger                             halo_exchanger_        ;
+  pa::block_sharer                               block_sharer_          ;
+  pa::block_cache                                block_cache_           ;
+  pa::time_slice_streamer                        time_slice_streamer_   ;
   pa::particle_tracer                            particle_tracer_       ;
+  pa::out_of_core_tracer                         out_of_core_tracer_    ;
+  pa::numa_scheduler                             numa_scheduler_        ;
+  pa::derived_field_generator                    derived_field_generator_;
   ray_tracer                                     ray_tracer_            ;
 
   std::optional<settings>                        last_settings_         ;
   std::optional<pa::scalar_field>                local_scalar_field_    ;
   std::optional<pa::vector_field>                local_vector_field_    ;
   std::array<std::optional<pa::vector_field>, 6> neighbor_vector_fields_;
-  std::vector<pa::particle>                      seeds_                 ;
+  std::array<std::shared_future<void>, 6>        neighbor_vector_fields_loaded_;
+  pa::particle_array                             seeds_                 ;
   std::vector<pa::integral_curves>               integral_curves_       ;
+  counter_list                                   counters_              ;
 };
 }
 
-#endif
+#endif
\ No newline at end of file
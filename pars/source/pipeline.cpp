@@ -1,5 +1,11 @@
 #include <pars/pipeline.hpp>
 
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <bm/bm.hpp>
 #include <tbb/tbb.h>
 
@@ -11,55 +17,121 @@
 
 namespace pars
 {
-pipeline::pipeline(const std::size_t thread_count) : environment_(boost::mpi::threading::level::serialized), partitioner_(&communicator_), data_io_(&partitioner_), particle_tracer_(&partitioner_), ray_tracer_(&partitioner_, thread_count)
+namespace
+{
+pa::vector_field::layout parse_vector_field_layout(const std::string& name)
+{
+  if      (name == "bricked")
+    return pa::vector_field::layout::bricked;
+  else if (name == "bricked_half")
+    return pa::vector_field::layout::bricked_half;
+  else if (name == "bricked_octahedral")
+    return pa::vector_field::layout::bricked_octahedral;
+  else if (name == "sparse")
+    return pa::vector_field::layout::sparse;
+  else if (name == "mapped")
+    return pa::vector_field::layout::mapped;
+  return pa::vector_field::layout::linear;
+}
+}
+
+pipeline::pipeline(const std::size_t thread_count) : environment_(boost::mpi::threading::level::multiple), partitioner_(&communicator_), data_io_(&partitioner_), in_situ_adapter_(&partitioner_), halo_exchanger_(&partitioner_), block_sharer_(&partitioner_, &data_io_), block_cache_(&data_io_), time_slice_streamer_(&data_io_), particle_tracer_(&partitioner_), out_of_core_tracer_(&partitioner_, &data_io_, &particle_tracer_), numa_scheduler_(thread_count), ray_tracer_(&partitioner_, thread_count)
 {
 
 }
+pipeline::~pipeline()
+{
+  // The neighbor vector fields may still be loading in the background.
+  for (auto& loaded : neighbor_vector_fields_loaded_)
+    if (loaded.valid())
+      loaded.wait();
+}
 
 std::pair<image, bm::mpi_session<>> pipeline::execute     (const settings& settings)
 {
-  auto volume_support           = settings.mode().find("volume"     ) != std::string::npos;
+  return execute(settings, false);
+}
+std::pair<image, bm::mpi_session<>> pipeline::execute_in_situ(const settings& settings)
+{
+  if (!in_situ_adapter_.has_vector_field())
+    throw std::runtime_error("In-situ execution requires a vector field.");
+
+  // The simulation provides the steady local block only.
+  auto in_situ_settings = settings;
+  in_situ_settings.set_particle_tracing_unsteady       (false);
+  in_situ_settings.set_particle_tracing_load_balance   (false);
+  in_situ_settings.set_particle_tracing_neighbor_paging(false);
+  in_situ_settings.set_particle_tracing_block_size     (0);
+  in_situ_settings.set_particle_tracing_node_sharing   (false);
+  return execute(in_situ_settings, true);
+}
+std::pair<image, bm::mpi_session<>> pipeline::execute     (const settings& settings, const bool in_situ)
+{
+  auto derived_volume           = !settings.volume_derived_field().empty(); // The volume is derived from the vector field rather than read from the dataset.
+  auto volume_support           = settings.mode().find("volume"     ) != std::string::npos && (!in_situ || derived_volume);
   auto streamline_support       = settings.mode().find("streamlines") != std::string::npos;    
+  auto vector_support           = streamline_support || (volume_support && derived_volume);
   auto export_support           = settings.mode().find("export"     ) != std::string::npos;                                       
-  auto dataset_params_changed   = !last_settings_.has_value() ||
-                                  last_settings_->dataset_filepath               ()  != settings.dataset_filepath               ()  ||
-                                  last_settings_->volume_type                    ()  != settings.volume_type                    ();
+  auto out_of_core              = settings.particle_tracing_block_size() > 0 && !settings.particle_tracing_unsteady(); // The local block is traced in smaller blocks, paged in one at a time.
+  auto node_sharing             = settings.particle_tracing_node_sharing() && !settings.particle_tracing_unsteady() && !out_of_core; // The blocks are loaded once per node into a shared window.
+  auto dataset_params_changed   = !last_settings_.has_value() || in_situ || // The memory of the simulation may have changed since the last execution.
+                                  last_settings_->dataset_filepath                   ()  != settings.dataset_filepath                   ()  ||
+                                  last_settings_->dataset_level                      ()  != settings.dataset_level                      ()  ||
+                                  last_settings_->dataset_readers                    ()  != settings.dataset_readers                    ()  ||
+                                  last_settings_->dataset_read_alignment             ()  != settings.dataset_read_alignment             ()  ||
+                                  last_settings_->dataset_collective_reads           ()  != settings.dataset_collective_reads           ()  ||
+                                  last_settings_->volume_type                        ()  != settings.volume_type                        ()  ||
+                                  last_settings_->volume_derived_field               ()  != settings.volume_derived_field               ()  ||
+                                  last_settings_->vector_field_layout                ()  != settings.vector_field_layout                ()  ||
+                                  last_settings_->scalar_field_layout                ()  != settings.scalar_field_layout                ()  ||
+                                  last_settings_->particle_tracing_unsteady          ()  != settings.particle_tracing_unsteady          ()  ||
+                                  last_settings_->particle_tracing_ghost_width       ()  != settings.particle_tracing_ghost_width       ()  ||
+                                  last_settings_->particle_tracing_load_balance_depth()  != settings.particle_tracing_load_balance_depth()  ||
+                                  last_settings_->particle_tracing_neighbor_paging   ()  != settings.particle_tracing_neighbor_paging   ()  ||
+                                  last_settings_->particle_tracing_block_size        ()  != settings.particle_tracing_block_size        ()  ||
+                                  last_settings_->particle_tracing_node_sharing      ()  != settings.particle_tracing_node_sharing      ()  ||
+                                  last_settings_->particle_tracing_numa              ()  != settings.particle_tracing_numa              ();
   auto advection_params_changed = !last_settings_.has_value() ||
-                                  last_settings_->seed_generation_stride         (0) != settings.seed_generation_stride         (0) ||
-                                  last_settings_->seed_generation_stride         (1) != settings.seed_generation_stride         (1) ||
-                                  last_settings_->seed_generation_stride         (2) != settings.seed_generation_stride         (2) ||
-                                  last_settings_->seed_generation_iterations     ()  != settings.seed_generation_iterations     ()  ||
-                                  last_settings_->particle_tracing_integrator    ()  != settings.particle_tracing_integrator    ()  ||
-                                  last_settings_->particle_tracing_step_size     ()  != settings.particle_tracing_step_size     ()  ||
-                                  last_settings_->particle_tracing_load_balance  ()  != settings.particle_tracing_load_balance  ()  ||
-                                  last_settings_->color_generation_mode          ()  != settings.color_generation_mode          ()  ||
-                                  last_settings_->color_generation_free_parameter()  != settings.color_generation_free_parameter()  ||
-                                  last_settings_->raytracing_streamline_radius   ()  != settings.raytracing_streamline_radius   ();
+                                  last_settings_->seed_generation_stride             (0) != settings.seed_generation_stride             (0) ||
+                                  last_settings_->seed_generation_stride             (1) != settings.seed_generation_stride             (1) ||
+                                  last_settings_->seed_generation_stride             (2) != settings.seed_generation_stride             (2) ||
+                                  last_settings_->seed_generation_iterations         ()  != settings.seed_generation_iterations         ()  ||
+                                  last_settings_->particle_tracing_integrator        ()  != settings.particle_tracing_integrator        ()  ||
+                                  last_settings_->particle_tracing_step_size         ()  != settings.particle_tracing_step_size         ()  ||
+                                  last_settings_->particle_tracing_load_balance      ()  != settings.particle_tracing_load_balance      ()  ||
+                                  last_settings_->particle_tracing_packet_mode       ()  != settings.particle_tracing_packet_mode       ()  ||
+                                  last_settings_->color_generation_mode              ()  != settings.color_generation_mode              ()  ||
+                                  last_settings_->color_generation_free_parameter    ()  != settings.color_generation_free_parameter    ()  ||
+                                  last_settings_->raytracing_streamline_radius       ()  != settings.raytracing_streamline_radius       () ;
   auto raytrace_params_changed  = !last_settings_.has_value() || 
-                                  last_settings_->raytracing_camera_position     (0) != settings.raytracing_camera_position     (0) ||
-                                  last_settings_->raytracing_camera_position     (1) != settings.raytracing_camera_position     (1) ||
-                                  last_settings_->raytracing_camera_position     (2) != settings.raytracing_camera_position     (2) ||
-                                  last_settings_->raytracing_camera_forward      (0) != settings.raytracing_camera_forward      (0) ||
-                                  last_settings_->raytracing_camera_forward      (1) != settings.raytracing_camera_forward      (1) ||
-                                  last_settings_->raytracing_camera_forward      (2) != settings.raytracing_camera_forward      (2) ||
-                                  last_settings_->raytracing_camera_up           (0) != settings.raytracing_camera_up           (0) ||
-                                  last_settings_->raytracing_camera_up           (1) != settings.raytracing_camera_up           (1) ||
-                                  last_settings_->raytracing_camera_up           (2) != settings.raytracing_camera_up           (2) ||
-                                  last_settings_->raytracing_image_size          (0) != settings.raytracing_image_size          (0) ||
-                                  last_settings_->raytracing_image_size          (1) != settings.raytracing_image_size          (1) ||
-                                  last_settings_->raytracing_iterations          ()  != settings.raytracing_iterations          ();
-                                  
+                                  last_settings_->raytracing_camera_position         (0) != settings.raytracing_camera_position         (0) ||
+                                  last_settings_->raytracing_camera_position         (1) != settings.raytracing_camera_position         (1) ||
+                                  last_settings_->raytracing_camera_position         (2) != settings.raytracing_camera_position         (2) ||
+                                  last_settings_->raytracing_camera_forward          (0) != settings.raytracing_camera_forward          (0) ||
+                                  last_settings_->raytracing_camera_forward          (1) != settings.raytracing_camera_forward          (1) ||
+                                  last_settings_->raytracing_camera_forward          (2) != settings.raytracing_camera_forward          (2) ||
+                                  last_settings_->raytracing_camera_up               (0) != settings.raytracing_camera_up               (0) ||
+                                  last_settings_->raytracing_camera_up               (1) != settings.raytracing_camera_up               (1) ||
+                                  last_settings_->raytracing_camera_up               (2) != settings.raytracing_camera_up               (2) ||
+                                  last_settings_->raytracing_image_size              (0) != settings.raytracing_image_size              (0) ||
+                                  last_settings_->raytracing_image_size              (1) != settings.raytracing_image_size              (1) ||
+                                  last_settings_->raytracing_iterations              ()  != settings.raytracing_iterations              ();
+
   auto session = bm::run_mpi<double, std::milli>([&] (bm::session_recorder<double, std::milli>& recorder)
   {
+    counters_.clear(); // Of the last iteration.
+
     communicator_.barrier();
 
     if (communicator_.rank() == 0) std::cout << "1.0::data_io::set_file\n";
     recorder.record("1.0::data_io::set_file"                   , [&] ()
     {
-      if (!dataset_params_changed)
+      if (!dataset_params_changed || in_situ)
         return;
 
-      data_io_.set_file(settings.dataset_filepath());
+      data_io_.set_file       (settings.dataset_filepath());
+      data_io_.set_level      (std::min<std::size_t>(std::max(settings.dataset_level(), 0), data_io_.load_level_count() - 1)); // Levels beyond the pyramid fall back to its coarsest level.
+      data_io_.set_aggregation(std::max(settings.dataset_readers(), 0), std::max(settings.dataset_read_alignment(), 0), settings.dataset_collective_reads());
     });
 
     communicator_.barrier();
@@ -67,7 +139,11 @@ std::pair<image, bm::mpi_session<>> pipeline::execute     (const settings& setti
     if (communicator_.rank() == 0) std::cout << "1.1::data_io::load_dimensions\n";
     recorder.record("1.1::data_io::load_dimensions"            , [&] ()
     {
+      if (in_situ) // Partitioned by in_situ_adapter::set_domain.
+        return;
+
       auto dimensions = data_io_.load_dimensions();
+      partitioner_.set_ghost_width(settings.particle_tracing_unsteady() || node_sharing ? 0 : settings.particle_tracing_ghost_width()); // Time slices are not exchanged, shared blocks are read-only.
       partitioner_.set_domain_size({dimensions[0], dimensions[1], dimensions[2]});
     });
 
@@ -76,9 +152,15 @@ std::pair<image, bm::mpi_session<>> pipeline::execute     (const settings& setti
     if (communicator_.rank() == 0) std::cout << "1.2::data_io::load_local_scalar_field\n";
     recorder.record("1.2::data_io::load_local_scalar_field"    , [&] ()
     {
-      if (!volume_support || !dataset_params_changed)
+      if (!volume_support || derived_volume || !dataset_params_changed)
         return;
 
+      if      (settings.scalar_field_layout() == std::string("sparse"))
+        data_io_.set_scalar_field_layout(pa::scalar_field::layout::sparse);
+      else if (settings.scalar_field_layout() == std::string("mapped"))
+        data_io_.set_scalar_field_layout(pa::scalar_field::layout::mapped);
+      else
+        data_io_.set_scalar_field_layout(pa::scalar_field::layout::linear);
       local_scalar_field_     = data_io_.load_local_scalar_field(settings.volume_type());
     });
 
@@ -87,19 +169,83 @@ std::pair<image, bm::mpi_session<>> pipeline::execute     (const settings& setti
     if (communicator_.rank() == 0) std::cout << "1.3::data_io::load_local_vector_field\n";
     recorder.record("1.3::data_io::load_local_vector_field"    , [&] ()
     {
-      if (!streamline_support || !dataset_params_changed)
+      if (!vector_support || !dataset_params_changed)
         return;
 
-      local_vector_field_     = data_io_.load_local_vector_field();
+      data_io_.set_vector_field_layout(parse_vector_field_layout(settings.vector_field_layout()));
+      block_sharer_.release(); // The vector fields viewing the window of the last load must not outlive it.
+      if (settings.particle_tracing_unsteady())
+      {
+        local_vector_field_.reset();
+        time_slice_streamer_.load(0);
+      }
+      else if (out_of_core)
+        local_vector_field_.reset();
+      else if (in_situ)
+        local_vector_field_   = in_situ_adapter_.load_local_vector_field();
+      else if (node_sharing)
+      {
+        neighbor_vector_fields_loaded_ = {};
+        block_sharer_.load(&local_vector_field_, settings.particle_tracing_load_balance() ? &neighbor_vector_fields_ : nullptr, settings.particle_tracing_load_balance_depth());
+      }
+      else
+        local_vector_field_   = data_io_.load_local_vector_field();
     });
-    if (communicator_.rank() == 0) std::cout << "1.4::data_io::load_neighbor_vector_fields\n";
-    recorder.record("1.4::data_io::load_neighbor_vector_fields", [&]()
+    if (communicator_.rank() == 0) std::cout << "1.4::data_io::load_neighbor_vector_fields_async\n";
+    recorder.record("1.4::data_io::load_neighbor_vector_fields_async", [&] ()
     {
       if (!streamline_support || !dataset_params_changed)
         return;
 
-      if (settings.particle_tracing_load_balance())
-        neighbor_vector_fields_ = data_io_.load_neighbor_vector_fields();
+      block_cache_.clear();
+      if (!settings.particle_tracing_load_balance() || settings.particle_tracing_unsteady() || out_of_core || node_sharing) // Shared neighbors are loaded along with the local block.
+        return;
+
+      // Either paged in by the tracer once it receives particles for a neighbor, or loaded in the background while seeding and tracing proceed.
+      if (settings.particle_tracing_neighbor_paging())
+      {
+        neighbor_vector_fields_ = {};
+        block_cache_.set_neighbor_depth(settings.particle_tracing_load_balance_depth());
+      }
+      else
+        neighbor_vector_fields_loaded_ = data_io_.load_neighbor_vector_fields_async(&neighbor_vector_fields_, settings.particle_tracing_load_balance_depth());
+    });
+    if (communicator_.rank() == 0) std::cout << "1.5::halo_exchanger::exchange\n";
+    recorder.record("1.5::halo_exchanger::exchange"            , [&] ()
+    {
+      if (!vector_support || !dataset_params_changed || settings.particle_tracing_unsteady() || out_of_core)
+        return;
+
+      halo_exchanger_.exchange(&local_vector_field_.value());
+    });
+    if (communicator_.rank() == 0) std::cout << "1.6::numa_scheduler::place\n";
+    recorder.record("1.6::numa_scheduler::place"               , [&] ()
+    {
+      if (!streamline_support || !dataset_params_changed || !settings.particle_tracing_numa() || !local_vector_field_)
+        return;
+
+      numa_scheduler_.place(local_vector_field_.value()); // After the halo exchange, which reallocates the storage.
+    });
+    if (communicator_.rank() == 0) std::cout << "1.7::derived_field_generator::generate\n";
+    recorder.record("1.7::derived_field_generator::generate"   , [&] ()
+    {
+      if (!volume_support || !derived_volume || !dataset_params_changed)
+        return;
+
+      if      (settings.volume_derived_field() == std::string("q_criterion"))
+        derived_field_generator_.set_mode(pa::derived_field_generator::mode::q_criterion);
+      else if (settings.volume_derived_field() == std::string("divergence"))
+        derived_field_generator_.set_mode(pa::derived_field_generator::mode::divergence);
+      else
+        derived_field_generator_.set_mode(pa::derived_field_generator::mode::vorticity_magnitude);
+
+      // Unsteady and out-of-core tracing keep no local block, which is loaded for the derivation only.
+      std::optional<pa::vector_field> loaded_vector_field;
+      if (!local_vector_field_)
+        loaded_vector_field = data_io_.load_local_vector_field();
+      derived_field_generator_.set_vector_field(local_vector_field_ ? &local_vector_field_.value() : &loaded_vector_field.value());
+      local_scalar_field_ = std::move(*derived_field_generator_.generate());
+      derived_field_generator_.set_vector_field(nullptr);
     });
 
     communicator_.barrier();
@@ -111,12 +257,27 @@ std::pair<image, bm::mpi_session<>> pipeline::execute     (const settings& setti
         return;
 
       pa::vector3 stride(settings.seed_generation_stride(0), settings.seed_generation_stride(1), settings.seed_generation_stride(2));
+      if (out_of_core) // The local block is not resident, hence empty regions are not skipped.
+      {
+        const auto spacing = data_io_.load_spacing();
+        seeds_ = pa::seed_generator::generate(
+          partitioner_.local_rank_info()->offset.cast<float>().array() * spacing.array(),
+          partitioner_.block_size     ()        .cast<float>().array() * spacing.array(),
+          spacing.array() * stride.array(),
+          settings.seed_generation_iterations(),
+          communicator_.rank());
+        return;
+      }
+
+      auto& vector_field = settings.particle_tracing_unsteady() ? *time_slice_streamer_.interval().start : local_vector_field_.value();
+
       seeds_ = pa::seed_generator::generate(
-        local_vector_field_->offset,
-        local_vector_field_->size  ,
-        local_vector_field_->spacing.array() * stride.array(),
+        vector_field.offset,
+        vector_field.size  ,
+        vector_field.spacing.array() * stride.array(),
         settings.seed_generation_iterations(),
-        communicator_.rank());
+        communicator_.rank(),
+        settings.particle_tracing_unsteady() ? nullptr : &vector_field); // Regions empty at the first time slice may fill later.
     });
 
     communicator_.barrier();
@@ -128,8 +289,16 @@ std::pair<image, bm::mpi_session<>> pipeline::execute     (const settings& setti
         return;
 
       particle_tracer_.set_local_vector_field    (&local_vector_field_    );
-      particle_tracer_.set_neighbor_vector_fields(&neighbor_vector_fields_);
+      particle_tracer_.set_neighbor_vector_fields(&neighbor_vector_fields_, neighbor_vector_fields_loaded_);
+      particle_tracer_.set_neighbor_depth        (settings.particle_tracing_load_balance_depth());
+      particle_tracer_.set_block_cache           (settings.particle_tracing_neighbor_paging() && !node_sharing ? &block_cache_ : nullptr);
+      particle_tracer_.set_numa_scheduler        (settings.particle_tracing_numa() ? &numa_scheduler_ : nullptr);
+      block_cache_    .set_memory_budget         (std::size_t(settings.particle_tracing_neighbor_budget()) * 1024 * 1024);
+      out_of_core_tracer_.set_block_size         (pa::ivector3::Constant(settings.particle_tracing_block_size()));
+      if (!settings.particle_tracing_scratch_directory().empty())
+        out_of_core_tracer_.set_cache_directory  (settings.particle_tracing_scratch_directory());
       particle_tracer_.set_step_size             (settings.particle_tracing_step_size());
+      particle_tracer_.set_packet_mode           (settings.particle_tracing_packet_mode());
       if      (settings.particle_tracing_integrator() == std::string("euler"))
         particle_tracer_.set_integrator(pa::euler_integrator                       ());
       else if (settings.particle_tracing_integrator() == std::string("modified_midpoint"))
@@ -154,9 +323,32 @@ std::pair<image, bm::mpi_session<>> pipeline::execute     (const settings& setti
     if (streamline_support && (dataset_params_changed || advection_params_changed))
     {
       integral_curves_.clear();
+      particle_tracer_.reset_sample_cache_statistics();
+
+      // Unsteady tracing proceeds interval by interval. Particles reaching the end of an interval continue in the next one.
+      const auto unsteady     = settings.particle_tracing_unsteady();
+      const auto load_balance = settings.particle_tracing_load_balance() && !unsteady; // Neighbor vector fields are steady.
+      if (unsteady && time_slice_streamer_.time_slice() != 0)
+        time_slice_streamer_.load(0);
+      particle_tracer_.set_unsteady_vector_field(unsteady ? &time_slice_streamer_.interval() : nullptr);
+
+      // Out-of-core tracing performs the rounds below internally, block by block.
+      if (out_of_core)
+      {
+        recorder.record("3.1.0::out_of_core_tracer::trace", [&]()
+        {
+          integral_curves_ = out_of_core_tracer_.trace(std::move(seeds_));
+          seeds_.clear();
+        });
+
+        const auto statistics = out_of_core_tracer_.statistics();
+        counters_.emplace_back("3.1::out_of_core_tracer::loads" , statistics[0]);
+        counters_.emplace_back("3.1::out_of_core_tracer::traced", statistics[1]);
+      }
 
-      pa::integer round_counter = 0;
-      bool        complete      = false;
+      pa::particle_array        expired_particles;
+      pa::integer               round_counter = 0;
+      bool                      complete      = out_of_core;
       while (!complete)
       {
         pa::particle_tracer::round_info round_info;
@@ -164,7 +356,7 @@ std::pair<image, bm::mpi_session<>> pipeline::execute     (const settings& setti
         // if (communicator_.rank() == 0) std::cout << "3.1." + std::to_string(round_counter) + ".0::particle_tracer::load_balance_distribute\n";
         recorder.record("3.1." + std::to_string(round_counter) + ".0::particle_tracer::load_balance_distribute"   , [&]()
         {
-          if (settings.particle_tracing_load_balance())
+          if (load_balance)
                        particle_tracer_.load_balance_distribute (seeds_                             );
         });
         // if (communicator_.rank() == 0) std::cout << "3.1." + std::to_string(round_counter) + ".1::particle_tracer::compute_round_info\n";
@@ -190,7 +382,7 @@ std::pair<image, bm::mpi_session<>> pipeline::execute     (const settings& setti
         // if (communicator_.rank() == 0) std::cout << "3.1." + std::to_string(round_counter) + ".5::particle_tracer::load_balance_collect\n";
         recorder.record("3.1." + std::to_string(round_counter) + ".5::particle_tracer::load_balance_collect"      , [&]()
         {
-          if (settings.particle_tracing_load_balance())
+          if (load_balance)
                        particle_tracer_.load_balance_collect    (                        round_info);
         });
         // if (communicator_.rank() == 0) std::cout << "3.1." + std::to_string(round_counter) + ".6::particle_tracer::out_of_bounds_redistribute\n";
@@ -203,9 +395,33 @@ std::pair<image, bm::mpi_session<>> pipeline::execute     (const settings& setti
         {
           complete   = particle_tracer_.check_completion        (seeds_                             );
         });
+        for (auto& particle : round_info.expired_particles)
+          expired_particles.push_back(particle);
+        if (unsteady && complete)
+        {
+          // if (communicator_.rank() == 0) std::cout << "3.1." + std::to_string(round_counter) + ".8::time_slice_streamer::advance\n";
+          recorder.record("3.1." + std::to_string(round_counter) + ".8::time_slice_streamer::advance"             , [&]()
+          {
+            complete = particle_tracer_.check_completion(expired_particles) || !time_slice_streamer_.advance();
+            if (!complete)
+              std::swap(seeds_, expired_particles);
+            expired_particles.clear();
+          });
+        }
 
         round_counter++;
       }
+
+      const auto sample_cache_statistics = particle_tracer_.sample_cache_statistics();
+      counters_.emplace_back("3.1::particle_tracer::sample_cache_hits"  , sample_cache_statistics[0]);
+      counters_.emplace_back("3.1::particle_tracer::sample_cache_misses", sample_cache_statistics[1]);
+
+      if (settings.particle_tracing_neighbor_paging())
+      {
+        const auto block_statistics = block_cache_.statistics();
+        counters_.emplace_back("3.1::block_cache::loads"    , block_statistics[0]);
+        counters_.emplace_back("3.1::block_cache::evictions", block_statistics[1]);
+      }
     }
 
     communicator_.barrier();
@@ -332,7 +548,10 @@ std::pair<image, bm::mpi_session<>> pipeline::execute     (const settings& setti
     if (communicator_.rank() == 0) std::cout << "6.6::ray_tracer::serialize\n";
   });
 
-  last_settings_ = settings;
+  if (in_situ) // The next execution reloads the dataset.
+    last_settings_.reset();
+  else
+    last_settings_ = settings;
 
   return {ray_tracer_.serialize(), session};
 }
@@ -351,10 +570,14 @@ std::pair<image, bm::mpi_session<>> pipeline::execute     (const settings& setti
 
   auto session = bm::run_mpi<double, std::milli>([&] (bm::session_recorder<double, std::milli>& recorder)
   {
+    counters_.clear(); // Of the last iteration.
+
     if (communicator_.rank() == 0) std::cout << "1.0::data_io::set_file\n";
     recorder.record("1.0::data_io::set_file"               , [&] ()
     {
-      data_io_.set_file(settings.dataset_filepath());
+      data_io_.set_file       (settings.dataset_filepath());
+      data_io_.set_level      (std::min<std::size_t>(std::max(settings.dataset_level(), 0), data_io_.load_level_count() - 1));
+      data_io_.set_aggregation(std::max(settings.dataset_readers(), 0), std::max(settings.dataset_read_alignment(), 0), settings.dataset_collective_reads());
     });
     if (communicator_.rank() == 0) std::cout << "1.1::data_io::load_dimensions\n";
     recorder.record("1.1::data_io::load_dimensions"        , [&] ()
@@ -365,6 +588,7 @@ std::pair<image, bm::mpi_session<>> pipeline::execute     (const settings& setti
     if (communicator_.rank() == 0) std::cout << "1.2::data_io::load_local_vector_field\n";
     recorder.record("1.2::data_io::load_local_vector_field", [&] ()
     {
+      data_io_.set_vector_field_layout(parse_vector_field_layout(settings.vector_field_layout()));
       vector_field = data_io_.load_local_vector_field();
     });
 
@@ -373,6 +597,7 @@ std::pair<image, bm::mpi_session<>> pipeline::execute     (const settings& setti
     {
       flow_map_generator.set_vector_field(&vector_field.value());
       flow_map_generator.set_step_size   (settings.particle_tracing_step_size());
+      flow_map_generator.set_packet_mode (settings.particle_tracing_packet_mode());
       if      (settings.particle_tracing_integrator() == std::string("euler"))
         flow_map_generator.set_integrator(pa::euler_integrator                       ());
       else if (settings.particle_tracing_integrator() == std::string("modified_midpoint"))
@@ -395,6 +620,10 @@ std::pair<image, bm::mpi_session<>> pipeline::execute     (const settings& setti
     {
       flow_map = flow_map_generator.generate(settings.seed_generation_iterations(), pa::scalar(1) / settings.seed_generation_stride()[0]);
     });
+
+    const auto sample_cache_statistics = flow_map_generator.sample_cache_statistics();
+    counters_.emplace_back("2.1::flow_map_generator::sample_cache_hits"  , sample_cache_statistics[0]);
+    counters_.emplace_back("2.1::flow_map_generator::sample_cache_misses", sample_cache_statistics[1]);
     
     if (communicator_.rank() == 0) std::cout << "3.0::ftle_map_generator::initialize\n";
     recorder.record("3.0::ftle_map_generator::initialize"  , [&] ()
@@ -422,4 +651,12 @@ boost::mpi::communicator*           pipeline::communicator()
 {
   return &communicator_;
 }
+pa::in_situ_adapter*                pipeline::in_situ_adapter()
+{
+  return &in_situ_adapter_;
+}
+const pipeline::counter_list&       pipeline::counters       () const
+{
+  return counters_;
+}
 }
\ No newline at end of file
@@ -2,10 +2,18 @@
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <boost/asio.hpp>
+#include <boost/mpi.hpp>
 #include <google/protobuf/util/json_util.h>
 #include <cppzmq/zmq.hpp>
 #include <stb/stb_image_write.h>
@@ -15,8 +23,89 @@
 #include <image.pb.h>
 #include <settings.pb.h>
 
+#include <sys/resource.h>
+
 namespace pars
 {
+namespace
+{
+// Gathers the peak resident set size of each rank, saves them as csv and reports the maximum.
+void save_peak_memory(boost::mpi::communicator* communicator, const std::string& filepath)
+{
+  rusage usage {};
+  getrusage(RUSAGE_SELF, &usage);
+  const auto peak_kilobytes = static_cast<long long>(usage.ru_maxrss);
+
+  std::vector<long long> peaks;
+  boost::mpi::gather(*communicator, peak_kilobytes, peaks, 0);
+  if (communicator->rank() != 0)
+    return;
+
+  std::ofstream file(filepath);
+  file << "rank,peak_resident_set_size_kb\n";
+  for (std::size_t i = 0; i < peaks.size(); ++i)
+    file << i << "," << peaks[i] << "\n";
+
+  std::cout << "Peak resident set size: " << *std::max_element(peaks.begin(), peaks.end()) / 1024 << " MB (maximum over ranks).\n";
+}
+// Gathers the counters of each rank, saves them as csv along with the hit rate hits / (hits + misses) of each "*_hits" / "*_misses" pair, and reports the hit rates over all ranks.
+// The values differ per rank, while the names of the counters and their order are the same on all ranks, as they depend on the settings only.
+void save_counters(boost::mpi::communicator* communicator, const pipeline::counter_list& counters, const std::string& filepath)
+{
+  std::vector<unsigned long long> values(counters.size());
+  std::transform(counters.begin(), counters.end(), values.begin(), [ ] (const auto& counter) { return static_cast<unsigned long long>(counter.second); });
+
+  std::vector<unsigned long long> gathered(values.size() * communicator->size());
+  boost::mpi::gather(*communicator, values.data(), int(values.size()), gathered.data(), 0);
+  if (communicator->rank() != 0)
+    return;
+
+  const std::string hits_suffix = "_hits", misses_suffix = "_misses";
+  std::vector<std::pair<std::string, std::array<std::size_t, 2>>> rates; // Name and indices of the hits and misses.
+  for (std::size_t i = 0; i < counters.size(); ++i)
+  {
+    auto& name = counters[i].first;
+    if (name.size() <= hits_suffix.size() || name.compare(name.size() - hits_suffix.size(), hits_suffix.size(), hits_suffix) != 0)
+      continue;
+    const auto prefix = name.substr(0, name.size() - hits_suffix.size());
+    const auto misses = std::find_if(counters.begin(), counters.end(), [&] (const auto& counter) { return counter.first == prefix + misses_suffix; });
+    if (misses != counters.end())
+      rates.push_back({prefix + "_hit_rate", {i, std::size_t(std::distance(counters.begin(), misses))}});
+  }
+
+  const auto rate = [ ] (const unsigned long long hits, const unsigned long long misses) { return hits + misses > 0 ? double(hits) / double(hits + misses) : 0.0; };
+
+  std::ofstream file(filepath);
+  file << "rank";
+  for (auto& counter : counters)
+    file << "," << counter.first;
+  for (auto& entry : rates)
+    file << "," << entry.first;
+  file << "\n";
+  for (std::size_t rank = 0; rank < std::size_t(communicator->size()); ++rank)
+  {
+    const auto row = gathered.data() + rank * values.size();
+    file << rank;
+    for (std::size_t i = 0; i < values.size(); ++i)
+      file << "," << row[i];
+    for (auto& entry : rates)
+      file << "," << rate(row[entry.second[0]], row[entry.second[1]]);
+    file << "\n";
+  }
+
+  for (auto& entry : rates)
+  {
+    unsigned long long hits = 0, misses = 0;
+    for (std::size_t rank = 0; rank < std::size_t(communicator->size()); ++rank)
+    {
+      hits   += gathered[rank * values.size() + entry.second[0]];
+      misses += gathered[rank * values.size() + entry.second[1]];
+    }
+    std::cout << entry.first << ": " << rate(hits, misses) * 100.0 << " % (over ranks).\n";
+  }
+}
+}
+
 void run      (const std::string& address)
 {
   pipeline pipeline;
@@ -54,6 +143,10 @@ void run      (const std::string& address)
     settings settings;
     settings.ParseFromString(request_string);
 
+    // Interactive requests are answered from the (coarser) preview level, until refinement is requested.
+    if (!settings.dataset_refine())
+      settings.set_dataset_level(std::max(settings.dataset_level(), settings.dataset_preview_level()));
+
     auto result = pipeline.execute(settings);
 
     if (pipeline.communicator()->rank() == 0)
@@ -83,6 +176,8 @@ void benchmark(const std::size_t thread_count, const std::string& settings_filep
 
     result.gather();
     result.to_csv(settings_filepath + ".csv");
+    save_peak_memory(pipeline.communicator(), settings_filepath + ".memory.csv");
+    save_counters   (pipeline.communicator(), pipeline.counters(), settings_filepath + ".counters.csv");
 
     if (pipeline.communicator()->rank() == 0)
       std::cout << "Saved benchmark.\n";
@@ -93,6 +188,8 @@ void benchmark(const std::size_t thread_count, const std::string& settings_filep
 
     result.second.gather();
     result.second.to_csv(settings_filepath + ".csv");
+    save_peak_memory(pipeline.communicator(), settings_filepath + ".memory.csv");
+    save_counters   (pipeline.communicator(), pipeline.counters(), settings_filepath + ".counters.csv");
 
     if (pipeline.communicator()->rank() == 0)
     {
@@ -1,5 +1,7 @@
 #include <pars/stages/ray_tracer.hpp>
 
+#include <string>
+
 #include <tbb/tbb.h>
 
 namespace pars
@@ -123,20 +125,43 @@ void  ray_tracer::set_volume         (pa::scalar_field* scalar_field)
   if (volume_)
     model_->removeVolume(*volume_);
 
-  boost::multi_array<float, 3> inverted_data(boost::extents[scalar_field->data.shape()[2]][scalar_field->data.shape()[1]][scalar_field->data.shape()[0]]);
-  tbb::parallel_for(std::size_t(0), inverted_data.shape()[0], std::size_t(1), [&] (const std::size_t x) {
-  tbb::parallel_for(std::size_t(0), inverted_data.shape()[1], std::size_t(1), [&] (const std::size_t y) {
-  tbb::parallel_for(std::size_t(0), inverted_data.shape()[2], std::size_t(1), [&] (const std::size_t z) {
-    inverted_data[x][y][z] = scalar_field->data[z][y][x];
-  });});});
+  const auto shape = scalar_field->shape();
+
+  // The voxels are handed over in their native type, i.e. 8 and 16-bit volumes are not converted to float.
+  const auto invert = [&] (const auto& at, const OSPDataType data_type)
+  {
+    boost::multi_array<decltype(at(0, 0, 0)), 3> inverted_data(boost::extents[shape[2]][shape[1]][shape[0]]);
+    tbb::parallel_for(std::size_t(0), inverted_data.shape()[0], std::size_t(1), [&] (const std::size_t x) {
+    tbb::parallel_for(std::size_t(0), inverted_data.shape()[1], std::size_t(1), [&] (const std::size_t y) {
+    tbb::parallel_for(std::size_t(0), inverted_data.shape()[2], std::size_t(1), [&] (const std::size_t z) {
+      inverted_data[x][y][z] = at(z, y, x);
+    });});});
+    volume_data_ = std::make_unique<ospray::cpp::Data>(inverted_data.num_elements(), data_type, inverted_data.data()); volume_data_->commit();
+  };
+
+  std::string voxel_type;
+  if      (scalar_field->data_layout == pa::scalar_field::layout::linear_8 )
+  {
+    invert([&] (const std::size_t x, const std::size_t y, const std::size_t z) { return scalar_field->data_8 [x][y][z]; }, OSP_UCHAR );
+    voxel_type = "uchar" ;
+  }
+  else if (scalar_field->data_layout == pa::scalar_field::layout::linear_16)
+  {
+    invert([&] (const std::size_t x, const std::size_t y, const std::size_t z) { return scalar_field->data_16[x][y][z]; }, OSP_USHORT);
+    voxel_type = "ushort";
+  }
+  else
+  {
+    invert([&] (const std::size_t x, const std::size_t y, const std::size_t z) { return scalar_field->at(x, y, z);      }, OSP_FLOAT );
+    voxel_type = "float" ;
+  }
 
   volume_      = std::make_unique<ospray::cpp::Volume>("shared_structured_volume"); // "block_bricked_volume"
-  volume_data_ = std::make_unique<ospray::cpp::Data>(inverted_data.num_elements(), OSP_FLOAT, inverted_data.data()); volume_data_->commit();
-  volume_->set      ("dimensions"      , ospcommon::vec3i(scalar_field->data.shape()[0], scalar_field->data.shape()[1], scalar_field->data.shape()[2]));
+  volume_->set      ("dimensions"      , ospcommon::vec3i(shape[0], shape[1], shape[2]));
   volume_->set      ("gridOrigin"      , ospcommon::vec3f(scalar_field->offset      [0], scalar_field->offset      [1], scalar_field->offset      [2]));
   volume_->set      ("gridSpacing"     , ospcommon::vec3f(scalar_field->spacing     [0], scalar_field->spacing     [1], scalar_field->spacing     [2]));
   volume_->set      ("transferFunction", *transfer_function_);
-  volume_->set      ("voxelType"       , "float");
+  volume_->set      ("voxelType"       , voxel_type.c_str());
   //volume_->set    ("voxelRange"      , ospcommon::vec2f(0.0f, 1.0f));
   volume_->set      ("voxelData"       , *volume_data_);
   //volume_->setRegion(scalar_field->data.origin(), ospcommon::vec3i {0, 0, 0}, ospcommon::vec3i(scalar_field->data.shape()[0], scalar_field->data.shape()[1], scalar_field->data.shape()[2]));
@@ -16,6 +16,7 @@ std::string settings_template = R"({
   "particle_tracing_integrator"    : "runge_kutta_4",
   "particle_tracing_step_size"     : 0.5,
   "particle_tracing_load_balance"  : $4,
+  "particle_tracing_block_size"    : $0,
   
   "color_generation_mode"          : "hsv_constant_s",
   "color_generation_free_parameter": 0.75,
@@ -25,8 +26,11 @@ std::string settings_template = R"({
   "raytracing_camera_up"           : [ 0.0, 1.0, 0.0 ],
   "raytracing_image_size"          : [ 1080, 1920 ],
   "raytracing_streamline_radius"   : 0.1,
-  "raytracing_iterations"          : 1
-})"; // $1 dataset filepath, $2 seed stride x/y/z, $3 seed iterations, $4 load balancing, $5/$6/$7 camera x/y/z.
+  "raytracing_iterations"          : 1,
+
+  "vector_field_layout"            : "$8",
+  "scalar_field_layout"            : "$9"
+})"; // $0 out-of-core block size, $1 dataset filepath, $2 seed stride x/y/z, $3 seed iterations, $4 load balancing, $5/$6/$7 camera x/y/z, $8 vector field layout, $9 scalar field layout.
 
 std::string slurm_script_template = R"(#!/bin/bash
 #SBATCH --job-name=$1
@@ -59,6 +63,8 @@ struct configuration
   std::vector<std::size_t> seed_iterations        ; // Combinatorial.
   std::vector<bool>        load_balancing         ; // Combinatorial.
   std::array<float, 3>     camera_position        ;
+  std::size_t              block_size             = 0; // Out-of-core block size, 0 for in-core tracing.
+  std::vector<std::string> vector_field_layouts   = {"linear", "bricked", "bricked_half", "bricked_octahedral", "sparse"}; // Combinatorial.
 };
 
 int main(int argc, char** argv)
@@ -108,29 +114,33 @@ int main(int argc, char** argv)
       {512, 1024, 2048, 4096},
       {true, false},
       {4000.0, 6000.0, -10000.0}
-    } //,
-    //configuration
-    //{
-    //  "/rwthfs/rz/cluster/hpcwork/ad784563/data/pli/msa/MSA0309_s0536-0695_c_s10.h5" , // ~3.3 TB
-    //  10,
-    //  {                    32,     48, 64,     128,      256     , 512, 1024},
-    //  {1, 2, 4, 8, 16, 24, 32, 48},
-    //  {1, 2, 4, 8, 16, 24, 32, 40, 48, 64, 80, 128, 160, 256, 320, 512},
-    //  {128, 256, 512, 1024, 2048, 4096},
-    //  {true, false},
-    //  {5000.0, 7500.0, -12500.0}
-    //},
-    //configuration
-    //{
-    //  "/rwthfs/rz/cluster/hpcwork/ad784563/data/pli/msa/MSA0309_s0536-0695_c_s16.h5" , // ~14 TB
-    //  16,
-    //  {                                128, 256, 512, 1024},
-    //  {1, 2, 4, 8, 16, 24, 32, 48},
-    //  {1, 2, 4, 8, 16, 24, 32, 48, 64, 128, 256, 512},
-    //  {128, 256, 512, 1024, 2048, 4096},
-    //  {true, false},
-    //  {8000.0, 12000.0, -20000.0}
-    //}
+    },
+    configuration
+    {
+      "/rwthfs/rz/cluster/hpcwork/ad784563/data/pli/msa/MSA0309_s0536-0695_c_s10.h5" , // ~3.3 TB, traced out-of-core.
+      10,
+      {                    32,     48, 64,     128,      256     , 512, 1024},
+      {1, 2, 4, 8, 16, 24, 32, 48},
+      {1, 2, 4, 8, 16, 24, 32, 40, 48, 64, 80, 128, 160, 256, 320, 512},
+      {128, 256, 512, 1024, 2048, 4096},
+      {false}, // Load balancing requires the neighbor blocks to be resident.
+      {5000.0, 7500.0, -12500.0},
+      256,
+      {"linear"} // Blocks are paged in from brick files regardless of the layout.
+    },
+    configuration
+    {
+      "/rwthfs/rz/cluster/hpcwork/ad784563/data/pli/msa/MSA0309_s0536-0695_c_s16.h5" , // ~14 TB, traced out-of-core.
+      16,
+      {                                128, 256, 512, 1024},
+      {1, 2, 4, 8, 16, 24, 32, 48},
+      {1, 2, 4, 8, 16, 24, 32, 48, 64, 128, 256, 512},
+      {128, 256, 512, 1024, 2048, 4096},
+      {false}, // Load balancing requires the neighbor blocks to be resident.
+      {8000.0, 12000.0, -20000.0},
+      256,
+      {"linear"} // Blocks are paged in from brick files regardless of the layout.
+    }
   };
 
   std::vector<std::string> scripts;
@@ -143,16 +153,20 @@ int main(int argc, char** argv)
     for (auto& seed_generation_stride : configuration.seed_generation_strides) {
     for (auto& seed_iteration         : configuration.seed_iterations        ) {
     for (auto  load_balance           : configuration.load_balancing         ) {
+    for (auto& vector_field_layout    : configuration.vector_field_layouts   ) {
       auto name = std::string("benchmark") +
         "_sc" + std::to_string(configuration.dataset_scale) +
         "_n"  + std::to_string(node) +
         "_p"  + std::to_string(processor) +
         "_st" + std::to_string(seed_generation_stride) +
         "_i"  + std::to_string(seed_iteration) +
-        "_lb" + (load_balance ? "1" : "0");
+        "_lb" + (load_balance ? "1" : "0") +
+        (configuration.block_size != 0 ? "_oc" + std::to_string(configuration.block_size) : "") +
+        (vector_field_layout != "linear" ? "_" + vector_field_layout : "");
 
       // Create the settings.
       auto settings = settings_template;
+      while (settings.find("$0") != std::string::npos) settings.replace(settings.find("$0"), 2, std::to_string(configuration.block_size));
       while (settings.find("$1") != std::string::npos) settings.replace(settings.find("$1"), 2, configuration.dataset_filepath);
       while (settings.find("$2") != std::string::npos) settings.replace(settings.find("$2"), 2, std::to_string(seed_generation_stride));
       while (settings.find("$3") != std::string::npos) settings.replace(settings.find("$3"), 2, std::to_string(seed_iteration));
@@ -160,6 +174,8 @@ int main(int argc, char** argv)
       while (settings.find("$5") != std::string::npos) settings.replace(settings.find("$5"), 2, std::to_string(configuration.camera_position[0]));
       while (settings.find("$6") != std::string::npos) settings.replace(settings.find("$6"), 2, std::to_string(configuration.camera_position[1]));
       while (settings.find("$7") != std::string::npos) settings.replace(settings.find("$7"), 2, std::to_string(configuration.camera_position[2]));
+      while (settings.find("$8") != std::string::npos) settings.replace(settings.find("$8"), 2, vector_field_layout);
+      while (settings.find("$9") != std::string::npos) settings.replace(settings.find("$9"), 2, vector_field_layout == "sparse" ? "sparse" : "linear");
 
       std::ofstream settings_stream(name + ".json");
       settings_stream << settings;
@@ -176,7 +192,7 @@ int main(int argc, char** argv)
       script_stream.close();
 
       scripts.push_back(name + ".sh");
-    }}}}}}
+    }}}}}}}
   }
 
   // Create master script, batching all scripts.
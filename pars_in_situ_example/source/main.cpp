@@ -0,0 +1,110 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <pars/pipeline.hpp>
+
+// Stands in for a simulation which advances a time-periodic Arnold-Beltrami-Childress flow on [0, 2 pi]^3.
+// Each rank keeps its region as separate double precision arrays with a padding layer on all sides, as a finite difference code would.
+struct simulation
+{
+  simulation(const pa::ivector3& offset, const pa::ivector3& size, const pa::scalar spacing) : offset(offset), size(size), spacing(spacing)
+  {
+    padded = size.array() + 2;
+    u.resize(padded.prod());
+    v.resize(padded.prod());
+    w.resize(padded.prod());
+  }
+
+  void advance(const double time)
+  {
+    const auto a = std::sqrt(3.0) + 0.5 * std::sin(time), b = std::sqrt(2.0), c = 1.0;
+    for (auto x = 0; x < size[0]; ++x)
+    for (auto y = 0; y < size[1]; ++y)
+    for (auto z = 0; z < size[2]; ++z)
+    {
+      const auto px    = (offset[0] + x) * spacing, py = (offset[1] + y) * spacing, pz = (offset[2] + z) * spacing;
+      const auto index = origin() + x * strides()[0] + y * strides()[1] + z;
+      u[index] = a * std::sin(pz) + c * std::cos(py);
+      v[index] = b * std::sin(px) + a * std::cos(pz);
+      w[index] = c * std::sin(py) + b * std::cos(px);
+    }
+  }
+
+  std::array<std::ptrdiff_t, 3> strides() const
+  {
+    return {std::ptrdiff_t(padded[1]) * padded[2], padded[2], 1};
+  }
+  std::ptrdiff_t                 origin () const // The first voxel of the region, past the padding.
+  {
+    return strides()[0] + strides()[1] + strides()[2];
+  }
+
+  pa::ivector3        offset ;
+  pa::ivector3        size   ;
+  pa::ivector3        padded ;
+  pa::scalar          spacing;
+  std::vector<double> u, v, w;
+};
+
+int main(const int argc, const char** argv)
+{
+  const auto resolution = argc > 1 ? std::stoi(argv[1]) : 128;
+  const auto steps      = argc > 2 ? std::stoi(argv[2]) : 4;
+  const auto spacing    = pa::scalar(2.0 * M_PI / (resolution - 1));
+
+  pars::pipeline pipeline;
+  auto           adapter = pipeline.in_situ_adapter();
+  adapter->set_domain(pa::ivector3::Constant(resolution), pa::vector3::Constant(spacing));
+
+  const auto region = adapter->local_region();
+  simulation simulation(region.first, region.second, spacing);
+
+  pars::settings settings;
+  settings.set_mode                           ("streamlines");
+  settings.add_seed_generation_stride         (8);
+  settings.add_seed_generation_stride         (8);
+  settings.add_seed_generation_stride         (8);
+  settings.set_seed_generation_iterations     (512);
+  settings.set_particle_tracing_integrator    ("runge_kutta_4");
+  settings.set_particle_tracing_step_size     (0.01f);
+  settings.set_color_generation_mode          ("hsv_constant_s");
+  settings.set_color_generation_free_parameter(0.75f);
+  for (const auto value : {0.5f * resolution * spacing, 0.5f * resolution * spacing, -1.5f * resolution * spacing})
+    settings.add_raytracing_camera_position   (value);
+  for (const auto value : {0.0f, 0.0f, 1.0f})
+    settings.add_raytracing_camera_forward    (value);
+  for (const auto value : {0.0f, 1.0f, 0.0f})
+    settings.add_raytracing_camera_up         (value);
+  settings.add_raytracing_image_size          (1920);
+  settings.add_raytracing_image_size          (1080);
+  settings.set_raytracing_streamline_radius   (0.01f);
+  settings.set_raytracing_iterations          (1);
+
+  for (auto step = 0; step < steps; ++step)
+  {
+    simulation.advance(0.25 * step);
+
+    // Views the padded arrays in place; they must not change until the execution returns.
+    const auto origin = simulation.origin();
+    adapter->set_vector_field({simulation.u.data() + origin, simulation.v.data() + origin, simulation.w.data() + origin}, simulation.strides());
+    auto result = pipeline.execute_in_situ(settings);
+
+    if (pipeline.communicator()->rank() == 0)
+    {
+      auto& image    = result.first;
+      auto  filepath = "in_situ_" + std::to_string(step) + ".ppm";
+      auto  pixels   = reinterpret_cast<const std::uint8_t*>(image.data().c_str());
+      std::ofstream file(filepath, std::ios::binary);
+      file << "P6\n" << image.size(0) << " " << image.size(1) << "\n255\n";
+      for (std::size_t i = 0; i < std::size_t(image.size(0)) * image.size(1); ++i)
+        file.write(reinterpret_cast<const char*>(pixels + 4 * i), 3);
+      std::cout << "Saved " << filepath << ".\n";
+    }
+  }
+  return 0;
+}
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/multi_array.hpp>
+#include <highfive/H5File.hpp>
+#include <tbb/tbb.h>
+
+#include <pa/math/brick_file.hpp>
+
+#undef min
+#undef max
+
+namespace
+{
+// Downsamples the source dataset by a factor of 2 per axis into the target dataset, with a [1 2 1] / 4 filter renormalized at the borders.
+// The voxel i of the target coincides with the voxel 2i of the source, hence the spacing of the target is twice the spacing of the source.
+// The target has the data type of the source, e.g. 8/16-bit volumes remain 8/16-bit, in which case the filtered values are rounded.
+void downsample(HighFive::File& file, const std::string& source_name, const std::string& target_name)
+{
+  const auto source     = file.getDataSet(source_name);
+  const auto dimensions = source.getDimensions();
+  const auto components = dimensions.size() == 4 ? dimensions[3] : 1;
+
+  std::vector<std::size_t> target_dimensions(dimensions);
+  for (auto i = 0; i < 3; ++i)
+    target_dimensions[i] = (dimensions[i] + 1) / 2;
+
+  const auto parent = target_name.substr(0, target_name.find_last_of('/'));
+  if (!file.exist(parent))
+    file.createGroup(parent);
+  auto       target  = file.createDataSet(target_name, HighFive::DataSpace(target_dimensions), source.getDataType());
+  const auto integer = H5Tget_class(source.getDataType().getId()) == H5T_INTEGER;
+
+  const auto weights = [ ] (const std::size_t index, const std::size_t size)
+  {
+    std::array<std::pair<std::size_t, float>, 3> result {{{index, 0.0f}, {index, 0.5f}, {index, 0.0f}}};
+    if (index > 0       ) result[0] = {index - 1, 0.25f};
+    if (index + 1 < size) result[2] = {index + 1, 0.25f};
+    const auto sum = result[0].second + result[1].second + result[2].second;
+    for (auto& weight : result)
+      weight.second /= sum;
+    return result;
+  };
+
+  // Each target plane is filtered from (at most) three source planes, hence the source is read one plane triple at a time.
+  std::vector<float> source_slab, target_slab(target_dimensions[1] * target_dimensions[2] * components);
+  for (std::size_t x = 0; x < target_dimensions[0]; ++x)
+  {
+    const auto begin = 2 * x > 0 ? 2 * x - 1 : 0;
+    const auto count = std::min<std::size_t>(2 * x + 2, dimensions[0]) - begin;
+    if (dimensions.size() == 4)
+    {
+      boost::multi_array<float, 4> data;
+      source.select({begin, 0, 0, 0}, {count, dimensions[1], dimensions[2], components}, {1, 1, 1, 1}).read(data);
+      source_slab.assign(data.data(), data.data() + data.num_elements());
+    }
+    else
+    {
+      boost::multi_array<float, 3> data;
+      source.select({begin, 0, 0   }, {count, dimensions[1], dimensions[2]            }, {1, 1, 1   }).read(data);
+      source_slab.assign(data.data(), data.data() + data.num_elements());
+    }
+
+    const auto weights_x = weights(2 * x, dimensions[0]);
+    tbb::parallel_for(tbb::blocked_range2d<std::size_t>(0, target_dimensions[1], 0, target_dimensions[2]), [&] (const tbb::blocked_range2d<std::size_t>& index) {
+      for (auto y = index.rows().begin(), y_end = index.rows().end(); y < y_end; ++y) {
+      for (auto z = index.cols().begin(), z_end = index.cols().end(); z < z_end; ++z) {
+        const auto weights_y = weights(2 * y, dimensions[1]);
+        const auto weights_z = weights(2 * z, dimensions[2]);
+        const auto element   = target_slab.data() + (y * target_dimensions[2] + z) * components;
+        std::fill_n(element, components, 0.0f);
+        for (auto& wx : weights_x) if (wx.second > 0.0f)
+        for (auto& wy : weights_y) if (wy.second > 0.0f)
+        for (auto& wz : weights_z) if (wz.second > 0.0f)
+        {
+          const auto weight = wx.second * wy.second * wz.second;
+          const auto value  = source_slab.data() + (((wx.first - begin) * dimensions[1] + wy.first) * dimensions[2] + wz.first) * components;
+          for (std::size_t c = 0; c < components; ++c)
+            element[c] += weight * value[c];
+        }
+        if (integer) // The filtered values lie within the range of the source, hence HDF5 converts the rounded values exactly.
+          std::transform(element, element + components, element, [ ] (const float value) { return std::round(value); });
+      }}
+    });
+
+    if (dimensions.size() == 4)
+    {
+      boost::multi_array<float, 4> data(boost::extents[1][target_dimensions[1]][target_dimensions[2]][components]);
+      std::copy(target_slab.begin(), target_slab.end(), data.data());
+      target.select({x, 0, 0, 0}, {1, target_dimensions[1], target_dimensions[2], components}, {1, 1, 1, 1}).write(data);
+    }
+    else
+    {
+      boost::multi_array<float, 3> data(boost::extents[1][target_dimensions[1]][target_dimensions[2]]);
+      std::copy(target_slab.begin(), target_slab.end(), data.data());
+      target.select({x, 0, 0   }, {1, target_dimensions[1], target_dimensions[2]            }, {1, 1, 1   }).write(data);
+    }
+  }
+}
+}
+
+// Converts datasets (or groups of datasets such as time_vectors) of an HDF5 file into brick files next to it, which data_io memory-maps in the mapped layouts.
+// With --levels n, additionally builds the levels 1 to n - 1 of the pyramid into the groups levels/1 ... levels/n-1 (see data_io::set_level) and converts them as well.
+// Levels which already exist (e.g. of an earlier run) are kept and only converted.
+// Usage: pars_preprocess <filepath> [--levels <count>] <dataset or group> [<dataset or group> ...]
+int main(const int argc, const char** argv)
+{
+  std::vector<std::string> arguments(argv + 1, argv + argc);
+
+  std::size_t levels = 1;
+  if (arguments.size() >= 3 && arguments[1] == "--levels")
+  {
+    levels = std::max(std::stoul(arguments[2]), 1ul);
+    arguments.erase(arguments.begin() + 1, arguments.begin() + 3);
+  }
+
+  if (arguments.size() < 2)
+  {
+    std::cout << "Usage: pars_preprocess <filepath> [--levels <count>] <dataset or group> [<dataset or group> ...]\n";
+    return 1;
+  }
+
+  const std::string filepath(arguments[0]);
+  HighFive::File    file    (filepath, levels > 1 ? HighFive::File::ReadWrite : HighFive::File::ReadOnly);
+
+  const auto level_name = [ ] (const std::size_t level, const std::string& name)
+  {
+    return level == 0 ? name : "levels/" + std::to_string(level) + "/" + name;
+  };
+  const auto convert    = [&] (const std::size_t level, const std::string& name)
+  {
+    if (level > 0)
+    {
+      if (file.exist(level_name(level, name)))
+        std::cout << "Keeping " << level_name(level, name) << "\n";
+      else
+      {
+        std::cout << "Downsampling " << level_name(level - 1, name) << " to " << level_name(level, name) << "\n";
+        downsample(file, level_name(level - 1, name), level_name(level, name));
+      }
+    }
+
+    auto filename = level_name(level, name);
+    std::replace(filename.begin(), filename.end(), '/', '_');
+    std::cout << "Converting " << level_name(level, name) << " to " << filepath + "." + filename + ".bricks" << "\n";
+    pa::brick_file::create(file.getDataSet(level_name(level, name)), filepath + "." + filename + ".bricks");
+  };
+
+  for (std::size_t level = 0; level < levels; ++level)
+  {
+    for (auto i = std::size_t(1); i < arguments.size(); ++i)
+    {
+      const auto& name = arguments[i];
+      try
+      {
+        auto group = file.getGroup(name);
+        if (level > 0)
+        {
+          auto level_group = file.exist(level_name(level, name)) ? file.getGroup(level_name(level, name)) : file.createGroup(level_name(level, name));
+          if (group.hasAttribute("time_spacing") && !level_group.hasAttribute("time_spacing"))
+          {
+            float time_spacing;
+            group.getAttribute("time_spacing").read(time_spacing);
+            level_group.createAttribute<float>("time_spacing", HighFive::DataSpace::From(time_spacing)).write(time_spacing);
+          }
+        }
+        for (auto& child : group.listObjectNames())
+          convert(level, name + "/" + child);
+      }
+      catch (const HighFive::GroupException&)
+      {
+        convert(level, name);
+      }
+    }
+  }
+  file.flush();
+  return 0;
+}
\ No newline at end of file
@@ -27,7 +27,7 @@ protected:
   void initialize_connection            ();
   void finalize_connection              ();
   void tick                             ();
-  void update_parameters                ();
+  void update_parameters                (const bool refine); // Auto updates are answered at the preview level, explicit updates at the level.
 
   void set_connection_widgets_enabled   (const bool enabled);
   void set_configuration_widgets_enabled(const bool enabled);
@@ -24,7 +24,7 @@ viewer::viewer(QWidget* parent) : QMainWindow(parent), timer_(this), context_(1)
   
   QObject::connect(button_update       , &QPushButton::clicked, [&] () 
   {
-    update_parameters();
+    update_parameters(true);
   });
   
   QObject::connect(checkbox_auto_update, &QCheckBox::clicked  , [&] (bool checked) 
@@ -96,7 +96,7 @@ void viewer::tick                             ()
     text_up_y      ->setText(QString::number(transform_.up         ()[1]));
     text_up_z      ->setText(QString::number(transform_.up         ()[2]));
 
-    update_parameters();
+    update_parameters(false);
   }
   else
   {
@@ -115,7 +115,7 @@ void viewer::tick                             ()
       text_up_z      ->text().toFloat()));
   }
 }
-void viewer::update_parameters                ()
+void viewer::update_parameters                (const bool refine)
 {
   std::string mode;
   if (checkbox_particle_advection_enabled->isChecked()) mode += "streamlines ";
@@ -125,6 +125,9 @@ void viewer::update_parameters                ()
   settings.set_mode                           (mode);
   settings.set_volume_type                    (combobox_scalars->currentText().toStdString());
   settings.set_dataset_filepath               (text_filepath->text().toStdString());
+  settings.set_dataset_level                  (text_level->text().toInt());
+  settings.set_dataset_preview_level          (text_preview_level->text().toInt());
+  settings.set_dataset_refine                 (refine);
   settings.add_seed_generation_stride         (text_stride_x->text().toInt());
   settings.add_seed_generation_stride         (text_stride_y->text().toInt());
   settings.add_seed_generation_stride         (text_stride_z->text().toInt());